@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "../Includes/broadphase.h"
+#include "../Includes/sweepAndPrune.h"
+#include "../Includes/spatialHashGrid.h"
+#include "../Includes/dynamicTree.h"
+
+// Compares the broadphases against an all-pairs test on scenes of 100x100
+// boxes, the size used by the demo, scattered so each box has a handful of
+// neighbours. Every step jitters the boxes slightly to mimic a running
+// simulation. Exits with 1 if any broadphase finds different pairs from the
+// all-pairs test on the final step.
+
+class BruteForceBroadphase : public Broadphase
+{
+public:
+  void findPairs(const std::vector<AABB> &bounds, std::vector<BodyPair> &pairs) override
+  {
+    pairs.clear();
+    int count = static_cast<int>(bounds.size());
+    for (int a = 0; a < count; a++)
+    {
+      for (int b = a + 1; b < count; b++)
+      {
+        if (aabbOverlap(bounds[a], bounds[b]))
+        {
+          pairs.push_back({a, b});
+        }
+      }
+    }
+  }
+
+  void query(const AABB &box, const std::vector<AABB> &bounds, std::vector<int> &bodies) const override
+  {
+    int count = static_cast<int>(bounds.size());
+    for (int i = 0; i < count; i++)
+    {
+      if (aabbOverlap(bounds[i], box))
+      {
+        bodies.push_back(i);
+      }
+    }
+  }
+};
+
+std::vector<AABB> makeScene(int count, std::mt19937 &random)
+{
+  float side = std::sqrt(static_cast<float>(count)) * 150.0f;
+  std::uniform_real_distribution<float> coordinate(0.0f, side);
+  std::uniform_real_distribution<float> size(80.0f, 120.0f);
+
+  std::vector<AABB> bounds(count);
+  for (AABB &box : bounds)
+  {
+    glm::vec2 center = glm::vec2(coordinate(random), coordinate(random));
+    glm::vec2 halfExtent = glm::vec2(size(random), size(random)) * 0.5f;
+    box.min = center - halfExtent;
+    box.max = center + halfExtent;
+  }
+  return bounds;
+}
+
+void jitter(std::vector<AABB> &bounds, std::mt19937 &random)
+{
+  std::uniform_real_distribution<float> offset(-2.0f, 2.0f);
+  for (AABB &box : bounds)
+  {
+    glm::vec2 delta = glm::vec2(offset(random), offset(random));
+    box.min += delta;
+    box.max += delta;
+  }
+}
+
+// Runs steps jittered steps and times findPairs over the last timedSteps
+// of them. Every broadphase sees the same sequence of scenes, so the pairs
+// of the final step are comparable whatever the timing window. Returns
+// those pairs sorted.
+std::vector<BodyPair> run(const char *name, Broadphase &broadphase, int count, int steps, int timedSteps)
+{
+  std::mt19937 random(1234);
+  std::vector<AABB> bounds = makeScene(count, random);
+  std::vector<BodyPair> pairs;
+
+  broadphase.findPairs(bounds, pairs);
+
+  double totalMs = 0.0;
+  for (int i = 0; i < steps; i++)
+  {
+    jitter(bounds, random);
+    if (i < steps - timedSteps)
+      continue;
+
+    auto start = std::chrono::steady_clock::now();
+    broadphase.findPairs(bounds, pairs);
+    auto end = std::chrono::steady_clock::now();
+    totalMs += std::chrono::duration<double, std::milli>(end - start).count();
+  }
+
+  printf("%-16s %8d bodies  %10.3f ms/step  %8zu pairs\n", name, count, totalMs / timedSteps, pairs.size());
+
+  for (BodyPair &pair : pairs)
+  {
+    if (pair.a > pair.b)
+      std::swap(pair.a, pair.b);
+  }
+  std::sort(pairs.begin(), pairs.end(), [](const BodyPair &x, const BodyPair &y)
+            { return x.a != y.a ? x.a < y.a : x.b < y.b; });
+  return pairs;
+}
+
+bool samePairs(const std::vector<BodyPair> &pairs, const std::vector<BodyPair> &expected)
+{
+  if (pairs.size() != expected.size())
+    return false;
+
+  for (size_t i = 0; i < pairs.size(); i++)
+  {
+    if (pairs[i].a != expected[i].a || pairs[i].b != expected[i].b)
+      return false;
+  }
+  return true;
+}
+
+// Brute force does not depend on earlier steps, so at 100k bodies only its
+// last step is timed; the broadphases still have to match its pairs.
+int main()
+{
+  const int counts[] = {1000, 10000, 100000};
+  int failures = 0;
+
+  for (int count : counts)
+  {
+    int steps = count >= 100000 ? 10 : 50;
+
+    BruteForceBroadphase bruteForce;
+    std::vector<BodyPair> expected = run("brute force", bruteForce, count, steps, count >= 100000 ? 1 : steps);
+
+    SweepAndPrune sweepAndPrune;
+    SpatialHashGrid grid(100.0f);
+    DynamicTree tree;
+    const char *names[] = {"sweep and prune", "hash grid", "dynamic tree"};
+    Broadphase *broadphases[] = {&sweepAndPrune, &grid, &tree};
+
+    for (int i = 0; i < 3; i++)
+    {
+      if (!samePairs(run(names[i], *broadphases[i], count, steps, steps), expected))
+      {
+        printf("%s: pairs differ from brute force at %d bodies\n", names[i], count);
+        failures++;
+      }
+    }
+  }
+
+  return failures == 0 ? 0 : 1;
+}
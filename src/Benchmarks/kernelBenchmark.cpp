@@ -0,0 +1,297 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include "../Includes/collision.h"
+#include "../Includes/rigidBody.h"
+
+// Microbenchmarks for the kernels the step is built from: box transforms
+// (the corners and edge normals that replaced getVertex and getNormal), edge
+// normals, the polygon SAT projection loop, the box SAT, manifold clipping,
+// the RigidBody impulse response and RigidBody::update over an array of
+// bodies. Each kernel is run several times and the fastest run is reported,
+// in ns per operation and millions of operations per second.
+//
+// To compare two builds, run the first with --save FILE and the second with
+// --compare FILE; each kernel then also shows its change against the saved
+// run, negative being faster.
+
+const int BODY_COUNT = 4096;
+const int PAIR_COUNT = 65536;
+const int RUNS = 7;
+const int MIN_OPERATIONS = 2000000;
+
+struct Result
+{
+  std::string name;
+  double nsPerOp;
+};
+
+// Repeats kernel, which performs operations operations per call, until at
+// least MIN_OPERATIONS have run, and keeps the fastest of RUNS such batches.
+// setup runs before each call and is not timed.
+template <typename Setup, typename Kernel>
+double timeKernel(int operations, Setup setup, Kernel kernel)
+{
+  int calls = std::max(1, MIN_OPERATIONS / operations);
+  double best = 0.0;
+  for (int run = 0; run < RUNS; run++)
+  {
+    std::chrono::steady_clock::duration elapsed{};
+    for (int i = 0; i < calls; i++)
+    {
+      setup();
+      auto start = std::chrono::steady_clock::now();
+      kernel();
+      elapsed += std::chrono::steady_clock::now() - start;
+    }
+
+    double ns = std::chrono::duration<double, std::nano>(elapsed).count() / (static_cast<double>(calls) * operations);
+    if (run == 0 || ns < best)
+      best = ns;
+  }
+  return best;
+}
+
+template <typename Kernel>
+double timeKernel(int operations, Kernel kernel)
+{
+  return timeKernel(operations, []() {}, kernel);
+}
+
+bool loadResults(const char *path, std::vector<Result> &results)
+{
+  FILE *file = fopen(path, "r");
+  if (!file)
+    return false;
+
+  char name[128];
+  double ns;
+  while (fscanf(file, "%127s %lf", name, &ns) == 2)
+  {
+    results.push_back(Result{name, ns});
+  }
+  fclose(file);
+  return true;
+}
+
+bool saveResults(const char *path, const std::vector<Result> &results)
+{
+  FILE *file = fopen(path, "w");
+  if (!file)
+    return false;
+
+  for (const Result &result : results)
+  {
+    fprintf(file, "%s %.6f\n", result.name.c_str(), result.nsPerOp);
+  }
+  fclose(file);
+  return true;
+}
+
+int main(int argc, char **argv)
+{
+  const char *savePath = nullptr;
+  const char *comparePath = nullptr;
+  for (int i = 1; i + 1 < argc; i += 2)
+  {
+    if (strcmp(argv[i], "--save") == 0)
+      savePath = argv[i + 1];
+    else if (strcmp(argv[i], "--compare") == 0)
+      comparePath = argv[i + 1];
+  }
+  if (argc % 2 == 0)
+  {
+    fprintf(stderr, "usage: %s [--save FILE] [--compare FILE]\n", argv[0]);
+    return 1;
+  }
+
+  std::vector<Result> baseline;
+  if (comparePath && !loadResults(comparePath, baseline))
+  {
+    fprintf(stderr, "could not read %s\n", comparePath);
+    return 1;
+  }
+
+  // Boxes packed densely enough that about half the pairs overlap, so the
+  // SAT kernels see both early outs and full tests.
+  std::mt19937 random(7);
+  std::uniform_real_distribution<float> coordinate(0.0f, 300.0f);
+  std::uniform_real_distribution<float> angle(0.0f, 360.0f);
+  std::uniform_real_distribution<float> size(40.0f, 160.0f);
+  std::uniform_real_distribution<float> velocity(-200.0f, 200.0f);
+  std::uniform_int_distribution<int> body(0, BODY_COUNT - 1);
+
+  std::vector<glm::vec2> positions(BODY_COUNT);
+  std::vector<float> rotations(BODY_COUNT), widths(BODY_COUNT), heights(BODY_COUNT);
+  std::vector<BoxTransform> transforms(BODY_COUNT);
+  std::vector<RigidBody> bodies;
+  bodies.reserve(BODY_COUNT);
+  for (int i = 0; i < BODY_COUNT; i++)
+  {
+    positions[i] = glm::vec2(coordinate(random), coordinate(random));
+    rotations[i] = angle(random);
+    widths[i] = size(random);
+    heights[i] = size(random);
+    transforms[i] = computeBoxTransform(positions[i], rotations[i], widths[i], heights[i]);
+
+    bodies.emplace_back(positions[i], rotations[i], widths[i], heights[i], 1.0f);
+    bodies.back().linearVelocity = glm::vec2(velocity(random), velocity(random));
+    bodies.back().angularVelocity = 0.0f;
+    bodies.back().forceVector = glm::vec2(0.0f, 0.0f);
+    bodies.back().torque = 0.0f;
+  }
+
+  std::vector<BodyPair> pairs(PAIR_COUNT);
+  for (BodyPair &pair : pairs)
+  {
+    pair.a = body(random);
+    do
+    {
+      pair.b = body(random);
+    } while (pair.b == pair.a);
+  }
+
+  std::vector<Result> results;
+  volatile float sink = 0.0f;
+
+  results.push_back({"computeBoxTransform", timeKernel(BODY_COUNT, [&]()
+                                                       {
+    for (int i = 0; i < BODY_COUNT; i++)
+    {
+      transforms[i] = computeBoxTransform(positions[i], rotations[i], widths[i], heights[i]);
+    } })});
+
+  results.push_back({"computeEdgeNormal", timeKernel(BODY_COUNT * 4, [&]()
+                                                     {
+    glm::vec2 sum(0.0f);
+    for (const BoxTransform &transform : transforms)
+    {
+      for (int e = 0; e < 4; e++)
+      {
+        sum += computeEdgeNormal(transform.vertices[e], transform.vertices[(e + 1) % 4]);
+      }
+    }
+    sink = sink + sum.x; })});
+
+  results.push_back({"projectVertex", timeKernel(BODY_COUNT * 4, [&]()
+                                                 {
+    float sum = 0.0f;
+    for (const BoxTransform &transform : transforms)
+    {
+      for (int v = 0; v < 4; v++)
+      {
+        sum += projectVertex(transform.vertices[v], transform.normals[0]);
+      }
+    }
+    sink = sink + sum; })});
+
+  results.push_back({"collidePolygons", timeKernel(PAIR_COUNT, [&]()
+                                                   {
+    int hits = 0;
+    SatResult result;
+    for (const BodyPair &pair : pairs)
+    {
+      const BoxTransform &a = transforms[pair.a];
+      const BoxTransform &b = transforms[pair.b];
+      hits += collidePolygons(a.vertices, a.normals, 4, a.center, b.vertices, b.normals, 4, result) ? 1 : 0;
+    }
+    sink = sink + hits; })});
+
+  results.push_back({"collideBoxes", timeKernel(PAIR_COUNT, [&]()
+                                                {
+    int hits = 0;
+    SatResult result;
+    for (const BodyPair &pair : pairs)
+    {
+      hits += collideBoxes(transforms[pair.a], transforms[pair.b], result) ? 1 : 0;
+    }
+    sink = sink + hits; })});
+
+  results.push_back({"collideBoxesManifold", timeKernel(PAIR_COUNT, [&]()
+                                                        {
+    int points = 0;
+    Manifold manifold;
+    for (const BodyPair &pair : pairs)
+    {
+      points += collideBoxesManifold(transforms[pair.a], transforms[pair.b], manifold);
+    }
+    sink = sink + points; })});
+
+  // The same pairs with every body taken as a circle of its width, or with
+  // b taken as one, to compare against the box tests above.
+  results.push_back({"collideCirclesManifold", timeKernel(PAIR_COUNT, [&]()
+                                                          {
+    int points = 0;
+    Manifold manifold;
+    for (const BodyPair &pair : pairs)
+    {
+      points += collideCirclesManifold(positions[pair.a], 0.5f * widths[pair.a], positions[pair.b], 0.5f * widths[pair.b], manifold);
+    }
+    sink = sink + points; })});
+
+  results.push_back({"collideBoxCircleManifold", timeKernel(PAIR_COUNT, [&]()
+                                                            {
+    int points = 0;
+    Manifold manifold;
+    for (const BodyPair &pair : pairs)
+    {
+      points += collideBoxCircleManifold(transforms[pair.a], positions[pair.b], 0.5f * widths[pair.b], manifold);
+    }
+    sink = sink + points; })});
+
+  // The response moves the bodies, so every call starts from the same copy.
+  std::vector<RigidBody> scratch;
+  auto resetBodies = [&]()
+  { scratch = bodies; };
+
+  results.push_back({"resolveCollision", timeKernel(PAIR_COUNT, resetBodies, [&]()
+                                                    {
+    for (const BodyPair &pair : pairs)
+    {
+      scratch[pair.a].resolveCollision(&scratch[pair.b]);
+    } })});
+
+  results.push_back({"RigidBody::update", timeKernel(BODY_COUNT, resetBodies, [&]()
+                                                     {
+    for (RigidBody &rigidBody : scratch)
+    {
+      rigidBody.update(1.0 / 60.0);
+    } })});
+
+  printf("%-24s %10s %12s", "kernel", "ns/op", "Mops/s");
+  if (comparePath)
+    printf(" %12s %8s", "baseline", "change");
+  printf("\n");
+
+  for (const Result &result : results)
+  {
+    printf("%-24s %10.3f %12.1f", result.name.c_str(), result.nsPerOp, 1000.0 / result.nsPerOp);
+    if (comparePath)
+    {
+      const Result *previous = nullptr;
+      for (const Result &candidate : baseline)
+      {
+        if (candidate.name == result.name)
+          previous = &candidate;
+      }
+
+      if (previous)
+        printf(" %12.3f %+7.1f%%", previous->nsPerOp, 100.0 * (result.nsPerOp / previous->nsPerOp - 1.0));
+      else
+        printf(" %12s %8s", "-", "-");
+    }
+    printf("\n");
+  }
+
+  if (savePath && !saveResults(savePath, results))
+  {
+    fprintf(stderr, "could not write %s\n", savePath);
+    return 1;
+  }
+
+  return 0;
+}
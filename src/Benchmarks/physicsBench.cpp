@@ -0,0 +1,297 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#include "../Includes/physicsWorld.h"
+
+// Headless benchmark of the whole world step, for catching regressions on
+// machines without a display. Builds one of the standard scenes, steps it at
+// 60 Hz and prints the step rate, per-phase timings and percentiles of the
+// step time as JSON, along with the world's counters from the last step.
+//
+// Usage: physics_bench [--scene pyramid|rain|pile|separated|all]
+//                      [--size N] [--frames N] [--warmup N] [--workers N]
+//                      [--sleep 0|1]
+//
+// size is the pyramid base, the number of boxes for rain and separated, and
+// the number of columns of the pile. Scenes are seeded, so runs are
+// repeatable. Sleep is off unless asked for, so settled scenes keep
+// measuring the solver.
+//
+// Global operator new is replaced to count heap allocations, so the report
+// also shows how many allocations the measured steps made. A warm step
+// should make none; if any scene's measured steps allocate, the scene is
+// named on stderr and the exit status is 1, so a build server can fail on it.
+// The first step reserves the world's step storage, so the check needs a
+// warm-up of at least one step.
+
+static std::atomic<long long> allocationCount{0};
+
+void *operator new(size_t size)
+{
+  allocationCount.fetch_add(1, std::memory_order_relaxed);
+  if (void *memory = malloc(size == 0 ? 1 : size))
+    return memory;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept
+{
+  free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept
+{
+  free(memory);
+}
+
+const float BOX_SIZE = 100.0f;
+const double TIME_STEP = 1.0 / 60.0;
+
+struct Options
+{
+  std::string scene = "all";
+  int size = 20;
+  int frames = 600;
+  int warmup = 60;
+  int workers = 1;
+  bool sleep = false;
+};
+
+// A static floor like the demo's square3, wide enough for every scene.
+void addFloor(PhysicsWorld &world, float width)
+{
+  int floor = world.addBody(glm::vec2(0.0f, -0.5f * BOX_SIZE), 0.0f, width, BOX_SIZE, 1.0f);
+  world.setStatic(floor, true);
+}
+
+void buildPyramid(PhysicsWorld &world, int base)
+{
+  addFloor(world, (base + 4) * BOX_SIZE);
+  for (int row = 0; row < base; row++)
+  {
+    int count = base - row;
+    float left = -0.5f * (count - 1) * BOX_SIZE;
+    for (int i = 0; i < count; i++)
+    {
+      world.addBody(glm::vec2(left + i * BOX_SIZE, (row + 0.5f) * BOX_SIZE), 0.0f, BOX_SIZE, BOX_SIZE, 1.0f);
+    }
+  }
+}
+
+// Boxes of mixed sizes and angles dropped from a band above the floor.
+void buildRain(PhysicsWorld &world, int count)
+{
+  float width = std::max(20.0f, std::sqrt(static_cast<float>(count)) * 2.0f) * BOX_SIZE;
+  addFloor(world, width);
+
+  std::mt19937 random(1);
+  std::uniform_real_distribution<float> x(-0.45f * width, 0.45f * width);
+  std::uniform_real_distribution<float> size(0.5f * BOX_SIZE, 1.5f * BOX_SIZE);
+  std::uniform_real_distribution<float> angle(0.0f, 90.0f);
+  float bandHeight = count * BOX_SIZE * BOX_SIZE * 4.0f / width;
+  std::uniform_real_distribution<float> y(2.0f * BOX_SIZE, 2.0f * BOX_SIZE + bandHeight);
+  for (int i = 0; i < count; i++)
+  {
+    world.addBody(glm::vec2(x(random), y(random)), angle(random), size(random), size(random), 1.0f);
+  }
+}
+
+// A wide, low pile: columns of three boxes side by side, one large island.
+void buildPile(PhysicsWorld &world, int columns)
+{
+  addFloor(world, (columns + 4) * BOX_SIZE);
+  float left = -0.5f * (columns - 1) * BOX_SIZE;
+  for (int i = 0; i < columns; i++)
+  {
+    for (int row = 0; row < 3; row++)
+    {
+      world.addBody(glm::vec2(left + i * BOX_SIZE, (row + 0.5f) * BOX_SIZE), 0.0f, BOX_SIZE, BOX_SIZE, 1.0f);
+    }
+  }
+}
+
+// Bodies spinning in zero gravity on a grid, all drifting with the same
+// velocity so the gaps between them never close; measures the per-body cost
+// of a step with no contacts. A box turning in place reaches at most half
+// its diagonal, well short of the next grid point.
+void buildSeparated(PhysicsWorld &world, int count)
+{
+  world.gravity = glm::vec2(0.0f, 0.0f);
+  int side = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(count))));
+
+  std::mt19937 random(2);
+  std::uniform_real_distribution<float> spin(-0.2f, 0.2f);
+  for (int i = 0; i < count; i++)
+  {
+    int body = world.addBody(glm::vec2((i % side) * 4.0f * BOX_SIZE, (i / side) * 4.0f * BOX_SIZE), 0.0f, BOX_SIZE, BOX_SIZE, 1.0f);
+    world.linearVelocities[body] = glm::vec2(20.0f, 10.0f);
+    world.angularVelocities[body] = spin(random);
+  }
+}
+
+void buildScene(PhysicsWorld &world, const std::string &scene, int size)
+{
+  if (scene == "pyramid")
+    buildPyramid(world, size);
+  else if (scene == "rain")
+    buildRain(world, size);
+  else if (scene == "pile")
+    buildPile(world, size);
+  else
+    buildSeparated(world, size);
+}
+
+double percentile(const std::vector<double> &sorted, double fraction)
+{
+  size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+  return sorted[index];
+}
+
+double mean(const std::vector<double> &values)
+{
+  double sum = 0.0;
+  for (double value : values)
+    sum += value;
+  return values.empty() ? 0.0 : sum / values.size();
+}
+
+// Returns the number of heap allocations made by the measured steps.
+long long runScene(const std::string &scene, const Options &options, bool last)
+{
+  PhysicsWorld world;
+  world.setWorkerCount(options.workers);
+  world.allowSleep = options.sleep;
+  buildScene(world, scene, options.size);
+
+  for (int i = 0; i < options.warmup; i++)
+  {
+    world.step(TIME_STEP);
+  }
+
+  std::vector<double> total, broadphase, narrowphase, islands, solver, continuous, sleep;
+  total.reserve(options.frames);
+  broadphase.reserve(options.frames);
+  narrowphase.reserve(options.frames);
+  islands.reserve(options.frames);
+  solver.reserve(options.frames);
+  continuous.reserve(options.frames);
+  sleep.reserve(options.frames);
+
+  long long allocationsBefore = allocationCount.load();
+  auto begin = std::chrono::steady_clock::now();
+  for (int i = 0; i < options.frames; i++)
+  {
+    world.step(TIME_STEP);
+    const StepProfile &profile = world.profile();
+    total.push_back(profile.total);
+    broadphase.push_back(profile.broadphase);
+    narrowphase.push_back(profile.narrowphase);
+    islands.push_back(profile.islands);
+    solver.push_back(profile.solver);
+    continuous.push_back(profile.continuous);
+    sleep.push_back(profile.sleep);
+  }
+  auto end = std::chrono::steady_clock::now();
+  long long allocations = allocationCount.load() - allocationsBefore;
+  double seconds = std::chrono::duration<double>(end - begin).count();
+
+  std::vector<double> sorted = total;
+  std::sort(sorted.begin(), sorted.end());
+
+  printf("    {\n");
+  printf("      \"scene\": \"%s\",\n", scene.c_str());
+  printf("      \"size\": %d,\n", options.size);
+  printf("      \"bodies\": %d,\n", world.bodyCount());
+  const StepProfile &profile = world.profile();
+  printf("      \"awakeBodies\": %d,\n", profile.awakeBodies);
+  printf("      \"candidatePairs\": %d,\n", profile.candidatePairs);
+  printf("      \"contacts\": %d,\n", profile.contacts);
+  printf("      \"satAxesTested\": %d,\n", profile.satAxesTested);
+  printf("      \"islands\": %d,\n", profile.islandCount);
+  printf("      \"frames\": %d,\n", options.frames);
+  printf("      \"stepsPerSecond\": %.2f,\n", seconds > 0.0 ? options.frames / seconds : 0.0);
+  printf("      \"allocationsPerStep\": %.3f,\n", static_cast<double>(allocations) / options.frames);
+  printf("      \"stepMs\": {\"mean\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, \"max\": %.4f},\n",
+         mean(total), percentile(sorted, 0.5), percentile(sorted, 0.9), percentile(sorted, 0.99), sorted.back());
+  printf("      \"phaseMs\": {\"broadphase\": %.4f, \"narrowphase\": %.4f, \"islands\": %.4f, \"solver\": %.4f, \"continuous\": %.4f, \"sleep\": %.4f}\n",
+         mean(broadphase), mean(narrowphase), mean(islands), mean(solver), mean(continuous), mean(sleep));
+  printf("    }%s\n", last ? "" : ",");
+  return allocations;
+}
+
+bool parseOptions(int argc, char **argv, Options &options)
+{
+  for (int i = 1; i < argc; i++)
+  {
+    if (i + 1 >= argc)
+      return false;
+
+    const char *value = argv[++i];
+    if (strcmp(argv[i - 1], "--scene") == 0)
+      options.scene = value;
+    else if (strcmp(argv[i - 1], "--size") == 0)
+      options.size = atoi(value);
+    else if (strcmp(argv[i - 1], "--frames") == 0)
+      options.frames = atoi(value);
+    else if (strcmp(argv[i - 1], "--warmup") == 0)
+      options.warmup = atoi(value);
+    else if (strcmp(argv[i - 1], "--workers") == 0)
+      options.workers = atoi(value);
+    else if (strcmp(argv[i - 1], "--sleep") == 0)
+      options.sleep = atoi(value) != 0;
+    else
+      return false;
+  }
+
+  return options.size > 0 && options.frames > 0 && options.warmup >= 0 && options.workers >= 0;
+}
+
+int main(int argc, char **argv)
+{
+  Options options;
+  if (!parseOptions(argc, argv, options))
+  {
+    fprintf(stderr, "usage: %s [--scene pyramid|rain|pile|separated|all] [--size N] [--frames N] [--warmup N] [--workers N] [--sleep 0|1]\n", argv[0]);
+    return 1;
+  }
+
+  std::vector<std::string> scenes = {"pyramid", "rain", "pile", "separated"};
+  if (options.scene != "all")
+  {
+    if (std::find(scenes.begin(), scenes.end(), options.scene) == scenes.end())
+    {
+      fprintf(stderr, "unknown scene '%s'\n", options.scene.c_str());
+      return 1;
+    }
+    scenes = {options.scene};
+  }
+
+  printf("{\n");
+  printf("  \"timeStep\": %.6f,\n", TIME_STEP);
+  printf("  \"warmup\": %d,\n", options.warmup);
+  printf("  \"workers\": %d,\n", options.workers);
+  printf("  \"sleep\": %s,\n", options.sleep ? "true" : "false");
+  printf("  \"results\": [\n");
+  bool allocated = false;
+  for (size_t i = 0; i < scenes.size(); i++)
+  {
+    long long allocations = runScene(scenes[i], options, i + 1 == scenes.size());
+    if (allocations > 0)
+    {
+      fprintf(stderr, "%s: %lld heap allocations in %d measured steps\n", scenes[i].c_str(), allocations, options.frames);
+      allocated = true;
+    }
+  }
+  printf("  ]\n");
+  printf("}\n");
+
+  return allocated ? 1 : 0;
+}
@@ -0,0 +1,63 @@
+#ifndef BROADPHASE_H
+#define BROADPHASE_H
+#include <vector>
+#include <glm/glm/glm.hpp>
+
+struct AABB
+{
+  glm::vec2 min;
+  glm::vec2 max;
+};
+
+inline bool aabbOverlap(const AABB &a, const AABB &b)
+{
+  return a.max.x >= b.min.x && b.max.x >= a.min.x && a.max.y >= b.min.y && b.max.y >= a.min.y;
+}
+
+// A candidate pair for the narrowphase, always stored with a < b.
+struct BodyPair
+{
+  int a;
+  int b;
+};
+
+inline AABB aabbUnion(const AABB &a, const AABB &b)
+{
+  return AABB{glm::min(a.min, b.min), glm::max(a.max, b.max)};
+}
+
+inline bool aabbContains(const AABB &outer, const AABB &inner)
+{
+  return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y && inner.max.x <= outer.max.x && inner.max.y <= outer.max.y;
+}
+
+inline float aabbPerimeter(const AABB &box)
+{
+  return 2.0f * ((box.max.x - box.min.x) + (box.max.y - box.min.y));
+}
+
+// Finds the pairs of bodies whose bounds overlap. bounds is indexed by body
+// id and grows as bodies are added to the world; implementations may keep
+// state between calls to exploit frame-to-frame coherence.
+//
+// query appends the bodies overlapping box to bodies, using the structure
+// built by the most recent findPairs call. It does not clear bodies first.
+//
+// When bodies have been destroyed, remapBodies is called before the next
+// findPairs. newIndices maps every body id of the last findPairs to its id
+// now, or -1 for a destroyed body; bodyCount is the number of bodies now.
+// Implementations that keep no state between calls can ignore it.
+//
+// reserve makes room for bodyCount bodies ahead of time, so findPairs does
+// not allocate while the world stays within it.
+class Broadphase
+{
+public:
+  virtual ~Broadphase() {}
+  virtual void findPairs(const std::vector<AABB> &bounds, std::vector<BodyPair> &pairs) = 0;
+  virtual void query(const AABB &box, const std::vector<AABB> &bounds, std::vector<int> &bodies) const = 0;
+  virtual void remapBodies(const std::vector<int> &, int) {}
+  virtual void reserve(int) {}
+};
+
+#endif
@@ -0,0 +1,146 @@
+#ifndef COLLISION_H
+#define COLLISION_H
+#include <glm/glm/glm.hpp>
+#include "broadphase.h"
+
+// 2D cross products: vector x vector gives the z component, scalar x vector
+// is an angular velocity applied to an offset.
+inline float cross(glm::vec2 a, glm::vec2 b)
+{
+  return a.x * b.y - a.y * b.x;
+}
+
+inline glm::vec2 cross(float s, glm::vec2 v)
+{
+  return glm::vec2(-s * v.y, s * v.x);
+}
+
+// Circles are stored like boxes with their diameter as both width and
+// height; only the pair tests and mass data tell them apart.
+enum class ShapeType : unsigned char
+{
+  Box,
+  Circle
+};
+
+// World-space shape data for one box. Computed once per body per step so the
+// pair tests never touch trig; every pair involving the body reads the same
+// corners and edge normals.
+struct BoxTransform
+{
+  glm::vec2 center;
+  glm::vec2 axisX;
+  glm::vec2 axisY;
+  glm::vec2 halfExtents;
+  glm::vec2 vertices[4];
+  glm::vec2 normals[4];
+};
+
+// One point of a contact manifold. id identifies the pair of features (edges
+// of either box) that produced the point, so a point can be matched with the
+// same point from the previous step. The impulses are accumulated by the
+// response and carried across steps through the contact cache.
+struct ContactPoint
+{
+  glm::vec2 position;
+  float separation;
+  unsigned int id;
+  float normalImpulse;
+  float tangentImpulse;
+};
+
+// Up to two contact points sharing one normal, which points from body A to
+// body B.
+struct Manifold
+{
+  glm::vec2 normal;
+  int pointCount;
+  ContactPoint points[2];
+};
+
+struct SatResult
+{
+  float overlap;
+  glm::vec2 axis;
+  glm::vec2 contactPoint;
+};
+
+bool intervalsOverlap(float minA, float maxA, float minB, float maxB);
+float projectVertex(const glm::vec2 &vertex, const glm::vec2 &axis);
+glm::vec2 computeEdgeNormal(const glm::vec2 &start, const glm::vec2 &end);
+
+BoxTransform computeBoxTransform(glm::vec2 position, float rotation, float width, float height);
+
+// Separating axis test between two convex polygons, using every edge normal
+// of both. Returns false as soon as a separating axis is found; otherwise
+// fills result with the axis of least overlap and an approximate contact
+// point measured from centerA.
+bool collidePolygons(const glm::vec2 *verticesA, const glm::vec2 *normalsA, int countA, glm::vec2 centerA,
+                     const glm::vec2 *verticesB, const glm::vec2 *normalsB, int countB, SatResult &result);
+
+// Box-box separating axis test. Two boxes only have four distinct axes between
+// them, and each box projects onto an axis as its center plus a radius built
+// from its half extents, so no corners are projected. Stops at the first
+// separating axis. Fills result the same way collidePolygons does.
+bool collideBoxes(const BoxTransform &a, const BoxTransform &b, SatResult &result);
+
+// Largest gap between two boxes along any of their four axes. A positive value
+// is a lower bound on the distance between the boxes; a negative one means
+// they overlap.
+float boxSeparation(const BoxTransform &a, const BoxTransform &b);
+
+// The same for any two shapes. A circle is its transform's center with
+// halfExtents.x as the radius, so circle pairs measure the real distance
+// between the surfaces rather than that of the boxes around them.
+float shapeSeparation(const BoxTransform &a, ShapeType shapeA, const BoxTransform &b, ShapeType shapeB);
+
+// Time of impact of a body of the given shape and size moving from one pose
+// to another against the fixed body b, by conservative advancement: the body
+// is moved forward by the separation divided by how fast any of its surface
+// points can move, which can never carry it past b. Turning a circle does not
+// move its surface. Returns the fraction of the motion at which the
+// separation first drops to target, or 1 if it never does.
+float timeOfImpact(glm::vec2 startPosition, float startRotation, glm::vec2 endPosition, float endRotation,
+                   float width, float height, ShapeType shape, const BoxTransform &b, ShapeType shapeB, float target);
+
+// Builds the contact manifold for two boxes by clipping the incident edge of
+// one box against the side planes of the reference face of the other. The
+// reference face is the axis of least penetration, with a tolerance that
+// prefers box A so the choice does not flip between steps. Returns the number
+// of points, 0 when the boxes are further apart than speculativeDistance.
+// Points within speculativeDistance but not yet touching are kept with a
+// positive separation.
+int collideBoxesManifold(const BoxTransform &a, const BoxTransform &b, Manifold &manifold, float speculativeDistance = 0.0f);
+
+// Circle-circle contact. A single point halfway between the two surfaces,
+// with the normal along the line between the centers, from a to b. Returns
+// 0 when the circles are further apart than speculativeDistance.
+int collideCirclesManifold(glm::vec2 centerA, float radiusA, glm::vec2 centerB, float radiusB, Manifold &manifold, float speculativeDistance = 0.0f);
+
+// Box-circle contact, with the normal pointing from the box to the circle.
+// The circle's center is taken into the box's frame with two dot products
+// and clamped to the half extents; a center inside the box is pushed out
+// through the nearest face. Same single point and return value as
+// collideCirclesManifold.
+int collideBoxCircleManifold(const BoxTransform &box, glm::vec2 center, float radius, Manifold &manifold, float speculativeDistance = 0.0f);
+
+enum class SimdLevel
+{
+  Scalar,
+  SSE,
+  AVX2
+};
+
+// Highest instruction set the batched kernels can use on this CPU.
+SimdLevel detectSimdLevel();
+
+// Tests many box pairs at once, 4 (SSE) or 8 (AVX2) per instruction stream.
+// Unlike collideBoxes every axis is always evaluated, so for a separated pair
+// result.overlap is negative and holds the largest separation, with axis set
+// to the axis it was found on. Overlapping pairs get the same result as
+// collideBoxes. Boxes must have a non-zero width and height. The first
+// overload picks the level with detectSimdLevel once.
+void collideBoxesBatch(const BoxTransform *transforms, const BodyPair *pairs, int count, SatResult *results);
+void collideBoxesBatch(const BoxTransform *transforms, const BodyPair *pairs, int count, SatResult *results, SimdLevel level);
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef CONSTRAINT_GRAPH_H
+#define CONSTRAINT_GRAPH_H
+#include <vector>
+#include "contactCache.h"
+
+// Greedy coloring of the contacts in one island so that no two contacts of
+// the same color share a dynamic body. Static bodies are ignored, since the
+// solver never writes to them, so a pile on one floor still colors well.
+//
+// color reorders the contacts of the range by color. Each color can then be
+// solved in parallel; the colors themselves run one after another. Contacts
+// that fit none of the maxColors colors land in an overflow range that has
+// to be solved serially.
+class ConstraintGraph
+{
+public:
+  static const int maxColors = 24;
+
+  // Color c covers [colorStarts[c], colorStarts[c + 1]); the overflow range
+  // is [colorStarts[maxColors], colorStarts[maxColors + 1]).
+  int colorStarts[maxColors + 2];
+
+  void reserve(int bodyCount, int contactCount);
+  void color(const std::vector<unsigned char> &staticFlags, std::vector<Contact> &contacts, int begin, int end);
+
+private:
+  std::vector<unsigned int> bodyColors;
+  std::vector<int> contactColors;
+  std::vector<Contact> sorted;
+};
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef CONTACT_CACHE_H
+#define CONTACT_CACHE_H
+#include <vector>
+#include "collision.h"
+
+struct Contact
+{
+  int a;
+  int b;
+  Manifold manifold;
+};
+
+// Contacts of the current step, keyed by body pair. Each step's manifolds are
+// matched against the previous step's by pair and then by feature id, so the
+// impulses accumulated on a contact point carry over for as long as the point
+// persists. Pairs that stop touching simply drop out; keep carries a pair
+// over unchanged, which is how contacts between sleeping bodies survive.
+//
+// The two contact lists and the lookup table are reused between steps, so no
+// allocation happens while the number of contacts stays within what reserve
+// made room for, or once it stops growing.
+class ContactCache
+{
+public:
+  std::vector<Contact> contacts;
+
+  void reserve(int contactCount);
+  void beginStep();
+  Contact &add(int a, int b, const Manifold &manifold);
+  bool keep(int a, int b);
+  const Contact *findPrevious(int a, int b) const;
+
+private:
+  std::vector<Contact> previous;
+  std::vector<int> table;
+};
+
+#endif
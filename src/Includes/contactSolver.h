@@ -0,0 +1,92 @@
+#ifndef CONTACT_SOLVER_H
+#define CONTACT_SOLVER_H
+#include <vector>
+#include <glm/glm/glm.hpp>
+#include "contactCache.h"
+
+class PhysicsWorld;
+
+struct ContactConstraintPoint
+{
+  glm::vec2 anchorA;
+  glm::vec2 anchorB;
+  float baseSeparation;
+  float normalMass;
+  float tangentMass;
+  float normalImpulse;
+  float tangentImpulse;
+  float velocityBias;
+};
+
+struct ContactConstraint
+{
+  int a;
+  int b;
+  glm::vec2 normal;
+  float friction;
+  float inverseMassA;
+  float inverseMassB;
+  float inverseInertiaA;
+  float inverseInertiaB;
+  int pointCount;
+  ContactConstraintPoint points[2];
+};
+
+// Spring terms of a soft contact for one substep length.
+struct Softness
+{
+  float biasRate;
+  float massScale;
+  float impulseScale;
+};
+
+// Sequential impulse solver over the world's contacts.
+//
+// reset records where every body starts. prepare then builds one constraint
+// per contact with the effective masses precomputed, starting from the
+// impulses the contact cache carried over.
+// solveVelocities applies friction and normal impulses, clamping the
+// accumulated impulse rather than each increment. solvePositions then removes
+// the remaining penetration by moving bodies directly; separations are
+// tracked from how far each body has moved since prepare, so the manifold
+// does not need rebuilding between iterations.
+//
+// solveSoft and applyRestitution make up the soft step used when the world
+// substeps: contacts act as stiff damped springs, so each substep needs only
+// one biased pass and one relaxing pass, with the bounce applied once at the
+// end. setSoftness derives the spring terms from the substep length.
+//
+// The constraints belong to the caller, so each thread can keep the ones it
+// solves in its own memory. prepare and storeImpulses map the contacts
+// [begin, end) to constraints[0] onwards; the other passes work on count
+// constraints. Sets of constraints that share no dynamic body can be solved
+// on different threads.
+class ContactSolver
+{
+public:
+  void reserve(int bodyCount);
+  void reset(PhysicsWorld &world, float deltaTime);
+  void prepare(const std::vector<Contact> &contacts, int begin, int end, ContactConstraint *constraints) const;
+  void warmStart(const ContactConstraint *constraints, int count);
+  void solveVelocities(ContactConstraint *constraints, int count);
+  void solvePositions(const ContactConstraint *constraints, int count);
+  void storeImpulses(const ContactConstraint *constraints, std::vector<Contact> &contacts, int begin, int end) const;
+
+  void setSoftness(float subStep, float contactHertz, float dampingRatio, float maxBiasVelocity);
+  void solveSoft(ContactConstraint *constraints, int count, bool useBias);
+  void applyRestitution(ContactConstraint *constraints, int count);
+
+private:
+  PhysicsWorld *world = nullptr;
+  float inverseDeltaTime = 0.0f;
+  float inverseSubStep = 0.0f;
+  Softness contactSoftness = {0.0f, 1.0f, 0.0f};
+  Softness staticSoftness = {0.0f, 1.0f, 0.0f};
+  float maxBiasVelocity = 0.0f;
+  std::vector<glm::vec2> startPositions;
+  std::vector<float> startRotations;
+
+  float currentSeparation(const ContactConstraint &constraint, const ContactConstraintPoint &point) const;
+};
+
+#endif
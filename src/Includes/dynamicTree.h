@@ -0,0 +1,67 @@
+#ifndef DYNAMIC_TREE_H
+#define DYNAMIC_TREE_H
+#include <vector>
+#include "broadphase.h"
+
+// Dynamic AABB tree broadphase. Each body owns a leaf holding a fattened copy
+// of its bounds, so a body that moves a little stays inside its leaf and the
+// tree is left alone. A body that escapes is removed and reinserted, and the
+// ancestors on the way back up are refitted and rebalanced with tree
+// rotations. Pairs are found by traversing the tree against itself.
+//
+// Proxies can also be created and destroyed directly, which keeps the cost of
+// adding or removing a body at runtime logarithmic.
+class DynamicTree : public Broadphase
+{
+public:
+  float margin;
+
+  DynamicTree(float margin = 10.0f);
+
+  void findPairs(const std::vector<AABB> &bounds, std::vector<BodyPair> &pairs) override;
+  void query(const AABB &box, const std::vector<AABB> &bounds, std::vector<int> &bodies) const override;
+  void remapBodies(const std::vector<int> &newIndices, int bodyCount) override;
+  void reserve(int bodyCount) override;
+
+  int createProxy(const AABB &box, int body);
+  void destroyProxy(int proxy);
+  bool moveProxy(int proxy, const AABB &box);
+  const AABB &getFatAABB(int proxy) const;
+  int getHeight() const;
+
+private:
+  struct TreeNode
+  {
+    AABB box;
+    int parent;
+    int child1;
+    int child2;
+    int height;
+    int body;
+  };
+
+  struct NodePair
+  {
+    int a;
+    int b;
+  };
+
+  std::vector<TreeNode> nodes;
+  int root = -1;
+  int freeList = -1;
+
+  std::vector<int> proxies;
+  std::vector<int> remappedProxies;
+  std::vector<NodePair> pairStack;
+  mutable std::vector<int> queryStack;
+
+  bool isLeaf(int node) const;
+  int allocateNode();
+  void freeNode(int node);
+  void insertLeaf(int leaf);
+  void removeLeaf(int leaf);
+  void refit(int node);
+  int balance(int node);
+};
+
+#endif
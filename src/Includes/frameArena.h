@@ -0,0 +1,51 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Linear allocator for data that only lives for one step. allocate bumps an
+// offset into a single block and reset rewinds it, so nothing is freed item
+// by item and nothing is constructed or destroyed; only trivially copyable
+// types belong here.
+//
+// A step that needs more than the block holds takes extra blocks from the
+// heap. The next reset replaces them with one block big enough for that
+// step, so once the scene stops growing a step allocates nothing.
+class FrameArena
+{
+public:
+  FrameArena(size_t capacity = 64 * 1024);
+
+  FrameArena(const FrameArena &) = delete;
+  FrameArena &operator=(const FrameArena &) = delete;
+
+  // Uninitialized room for count values, valid until the next reset.
+  template <typename T>
+  T *allocate(int count)
+  {
+    static_assert(alignof(T) <= alignof(std::max_align_t), "FrameArena only aligns to max_align_t");
+    return static_cast<T *>(allocateBytes(sizeof(T) * static_cast<size_t>(count), alignof(T)));
+  }
+
+  void reset();
+
+  // Grows the block to at least capacity bytes. Only valid right after a
+  // reset, before anything has been allocated.
+  void reserve(size_t capacity);
+
+  // Bytes handed out since the last reset.
+  size_t used() const;
+  size_t capacity() const;
+
+private:
+  std::unique_ptr<std::max_align_t[]> block;
+  size_t blockSize = 0;
+  size_t offset = 0;
+  size_t overflowUsed = 0;
+  std::vector<std::unique_ptr<std::max_align_t[]>> overflow;
+
+  void *allocateBytes(size_t bytes, size_t alignment);
+};
+
+#endif
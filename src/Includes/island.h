@@ -0,0 +1,46 @@
+#ifndef ISLAND_H
+#define ISLAND_H
+#include <vector>
+#include "contactCache.h"
+
+// A group of dynamic bodies connected through contacts. Static bodies never
+// join an island, so two piles resting on the same floor stay independent.
+struct Island
+{
+  int bodyBegin;
+  int bodyCount;
+  int contactBegin;
+  int contactCount;
+  bool awake;
+};
+
+// Splits the contact graph into islands with a union-find over the contacts
+// between dynamic bodies.
+//
+// build reorders the contact list so that each island's contacts are
+// contiguous and can be handed to the solver as one range. Awake islands
+// come first; an island is awake if any one of its bodies is.
+class IslandBuilder
+{
+public:
+  std::vector<Island> islands;
+  std::vector<int> bodies;
+  int awakeIslandCount = 0;
+  int awakeContactCount = 0;
+
+  void reserve(int bodyCount, int contactCount);
+  void build(const std::vector<unsigned char> &staticFlags, const std::vector<unsigned char> &awakeFlags, std::vector<Contact> &contacts);
+
+private:
+  std::vector<int> parent;
+  std::vector<int> islandOf;
+  std::vector<int> order;
+  std::vector<Island> unordered;
+  std::vector<int> contactIslands;
+  std::vector<Contact> sorted;
+
+  int findRoot(int body);
+  void merge(int a, int b);
+};
+
+#endif
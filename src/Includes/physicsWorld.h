@@ -0,0 +1,294 @@
+#ifndef PHYSICS_WORLD_H
+#define PHYSICS_WORLD_H
+#include <vector>
+#include <memory>
+#include <glm/glm/glm.hpp>
+#include "broadphase.h"
+#include "collision.h"
+#include "contactCache.h"
+#include "contactSolver.h"
+#include "island.h"
+#include "threadPool.h"
+#include "constraintGraph.h"
+#include "profiler.h"
+#include "frameArena.h"
+
+// How contacts are solved; see the SoftStep settings in PhysicsWorld.
+enum class SolverMode
+{
+  SequentialImpulse,
+  SoftStep
+};
+
+// Names a body for as long as it exists. Body indices change when other
+// bodies are destroyed; handles do not, and a handle to a destroyed body
+// stays invalid even once its slot is reused.
+struct BodyHandle
+{
+  int slot;
+  unsigned int generation;
+};
+
+// Owns every body in the simulation. Body state is kept as parallel arrays
+// (structure of arrays) indexed by the id returned from addBody, so the
+// integration and collision passes walk contiguous memory.
+//
+// Rotations are in degrees, as Renderer expects; angular velocities are in
+// radians per second.
+class PhysicsWorld
+{
+public:
+  glm::vec2 gravity = glm::vec2(0.0f, -981.00f);
+
+  // Solver settings. linearSlop is the penetration left alone to keep
+  // contacts alive, positionCorrection the fraction of the rest removed per
+  // position iteration, capped at maxLinearCorrection. Impacts slower than
+  // restitutionThreshold do not bounce.
+  int velocityIterations = 8;
+  int positionIterations = 3;
+  bool warmStarting = true;
+  float linearSlop = 0.5f;
+  float positionCorrection = 0.2f;
+  float maxLinearCorrection = 20.0f;
+  float restitutionThreshold = 100.0f;
+
+  // Pairs closer than speculativeMargin get speculative contacts, which let
+  // the solver stop them before they meet instead of after they overlap.
+  // Each moving body adds the distance it can cover in one step, capped at
+  // maxSpeculativeDistance so a fast body does not collect contacts with
+  // everything it passes; for bullets the sweep covers what is left.
+  float speculativeMargin = 2.0f;
+  float maxSpeculativeDistance = 100.0f;
+
+  // SoftStep detects collisions once per step and then runs solverSubSteps
+  // substeps of integrate, one biased solve and one relaxing solve, instead
+  // of the iteration counts above. Contacts push apart as springs of
+  // contactHertz, damped by contactDampingRatio, no faster than
+  // maxContactPushVelocity. Softer springs let tall stacks buckle.
+  SolverMode solverMode = SolverMode::SequentialImpulse;
+  int solverSubSteps = 4;
+  float contactHertz = 30.0f;
+  float contactDampingRatio = 10.0f;
+  float maxContactPushVelocity = 300.0f;
+
+  // Sleep settings. Once every body of an island has stayed under both
+  // velocity limits for timeToSleep seconds, the whole island is put to sleep
+  // and skipped until something touches it or a force is applied to it.
+  bool allowSleep = true;
+  float sleepLinearVelocity = 5.0f;
+  float sleepAngularVelocity = 0.035f;
+  float timeToSleep = 0.5f;
+
+  // advance runs the simulation in steps of fixedTimeStep, at most
+  // maxSubSteps per call. Time beyond that is dropped, so a slow frame can
+  // not snowball into ever more steps on the next one.
+  double fixedTimeStep = 1.0 / 60.0;
+  int maxSubSteps = 8;
+
+  // Islands with at least this many contacts are graph colored and solved
+  // one color at a time across all workers, instead of as a single job.
+  int graphColoringThreshold = 256;
+
+  // The lists each step fills are reserved for this many broadphase pairs
+  // and contacts per body, and again whenever the body count outgrows the
+  // last reservation. A step only allocates if its scene is packed tighter
+  // than this or bodies were added since the last reservation.
+  int pairsPerBody = 8;
+  int contactsPerBody = 4;
+
+  std::vector<glm::vec2> positions;
+  std::vector<float> rotations;
+  std::vector<glm::vec2> linearVelocities;
+  std::vector<float> angularVelocities;
+  std::vector<glm::vec2> forces;
+  std::vector<float> torques;
+
+  // Circles hold their diameter in both widths and heights.
+  std::vector<ShapeType> shapes;
+  std::vector<float> widths;
+  std::vector<float> heights;
+  std::vector<float> masses;
+
+  // Mass data derived from the mass, size and static flag, so the solver
+  // never divides. Static bodies and bodies without mass get zero inverses.
+  // setStatic, setMass and setSize keep these current; call updateMassData
+  // after writing masses, widths or heights directly.
+  std::vector<float> inverseMasses;
+  std::vector<float> inertias;
+  std::vector<float> inverseInertias;
+
+  std::vector<float> restitutions;
+  std::vector<float> frictions;
+  std::vector<unsigned char> staticFlags;
+  std::vector<unsigned char> awakeFlags;
+  std::vector<float> sleepTimes;
+  std::vector<unsigned char> bulletFlags;
+
+  // Poses before the most recent fixed step taken by advance.
+  std::vector<glm::vec2> previousPositions;
+  std::vector<float> previousRotations;
+
+  // Defaults to SweepAndPrune. Swap in a SpatialHashGrid for dense scenes of
+  // similarly sized bodies, or a DynamicTree for scenes mixing large static
+  // bodies with many small ones.
+  std::unique_ptr<Broadphase> broadphase;
+
+  PhysicsWorld();
+
+  // Awake islands are solved in parallel on this many threads, counting the
+  // one calling step. 0 uses one per core, 1 keeps everything on the caller.
+  void setWorkerCount(int count);
+  int workerCount() const;
+
+  // Bodies are packed into the arrays above by index. addBody returns the
+  // new body's index, which stays valid for as long as no body is destroyed;
+  // createBody returns a handle that stays valid until the body itself is.
+  // destroyBody moves the last body into the freed index, so the arrays stay
+  // dense. Creating runs in constant time. Destroying does too, except that
+  // the first destroy after a step records the handle of every body and the
+  // next step remaps its contacts through them, each linear in the body
+  // count; batching destroys between steps shares that cost. Destroying a
+  // body wakes the bodies that were touching it on the next step.
+  int addBody(glm::vec2 position, float rotation, float width, float height, float mass);
+  BodyHandle createBody(glm::vec2 position, float rotation, float width, float height, float mass);
+  int addCircle(glm::vec2 position, float radius, float mass);
+  BodyHandle createCircle(glm::vec2 position, float radius, float mass);
+  bool destroyBody(BodyHandle body);
+  int bodyCount() const;
+
+  // -1 if the body has been destroyed.
+  int bodyIndex(BodyHandle body) const;
+  BodyHandle bodyHandle(int body) const;
+  bool isValid(BodyHandle body) const;
+
+  void setStatic(int body, bool isStatic);
+  void setMass(int body, float mass);
+  void setSize(int body, float width, float height);
+  void updateMassData(int body);
+  // Positions written directly into a sleeping body are not picked up until
+  // it is woken.
+  void setAwake(int body, bool awake);
+  bool isAwake(int body) const;
+  // Bullets are swept from their old pose to their new one after every step
+  // and stopped at the first body in the way, so they can not pass through
+  // thin bodies. Only bullets pay for this.
+  void setBullet(int body, bool bullet);
+  void applyForce(int body, glm::vec2 force);
+  void applyForce(int body, glm::vec2 force, glm::vec2 point);
+  void applyTorque(int body, float torqueAdd);
+
+  void step(double deltaTime);
+
+  // Adds frameTime seconds of wall time to the accumulator and takes as many
+  // fixed steps as fit. Returns the number of steps taken.
+  int advance(double frameTime);
+
+  // How far the accumulator is into the next fixed step, from 0 to 1. Drawing
+  // bodies at the interpolated poses hides the mismatch between the render
+  // and physics rates.
+  float interpolationAlpha() const;
+  glm::vec2 interpolatedPosition(int body) const;
+  float interpolatedRotation(int body) const;
+
+  // Timings and counters of the last step. See profiler.h.
+  const StepProfile &profile() const;
+
+  void queryAABB(const AABB &box, std::vector<int> &bodies) const;
+  const std::vector<Contact> &getContacts() const;
+
+private:
+  std::vector<BoxTransform> transforms;
+  std::vector<AABB> bounds;
+  std::vector<float> reaches;
+  std::vector<BodyPair> pairs;
+  BodyPair *circlePairs = nullptr;
+  int circlePairCount = 0;
+
+  // slotBodies maps a handle's slot to the body's index, -1 once the body is
+  // gone; bodySlots is the reverse. steppedHandles holds the handle of every
+  // index as of the last step, taken when the first body is destroyed after
+  // it, so the contacts and broadphase can be remapped on the next step.
+  std::vector<int> slotBodies;
+  std::vector<unsigned int> slotGenerations;
+  std::vector<int> freeSlots;
+  std::vector<int> bodySlots;
+  std::vector<BodyHandle> steppedHandles;
+  std::vector<int> remappedBodies;
+  bool bodiesDestroyed = false;
+
+  // Holds everything that only lives for one step and is reset at the start
+  // of each; the arrays below point into it.
+  FrameArena frameArena;
+  SatResult *satResults = nullptr;
+  ContactCache contactCache;
+  ContactSolver solver;
+  IslandBuilder islandBuilder;
+  std::unique_ptr<ThreadPool> threadPool;
+  ConstraintGraph constraintGraph;
+  int *parallelIslands = nullptr;
+  int *coloredIslands = nullptr;
+  int parallelIslandCount = 0;
+  int coloredIslandCount = 0;
+  ContactConstraint *coloredConstraints = nullptr;
+  int coloredContactBegin = 0;
+
+  struct Sweep
+  {
+    int body;
+    glm::vec2 position;
+    float rotation;
+  };
+
+  Sweep *sweeps = nullptr;
+  int sweepCount = 0;
+  std::vector<int> sweepCandidates;
+  float solverDeltaTime = 0.0f;
+  float integrationStep = 0.0f;
+  double accumulator = 0.0;
+  StepProfile stepProfile = {};
+  int reservedBodyCount = 0;
+
+  enum class SolverStage
+  {
+    Prepare,
+    WarmStart,
+    Velocities,
+    Positions,
+    StoreImpulses,
+    IntegrateVelocities,
+    Integrate,
+    SoftSolve,
+    SoftRelax,
+    Restitution
+  };
+
+  struct StageJob
+  {
+    PhysicsWorld *world;
+    SolverStage stage;
+    int offset;
+  };
+
+  void integrateVelocities(int begin, int end, float deltaTime);
+  void clearForces();
+  void integratePositions(int begin, int end, float deltaTime);
+  void remapDestroyedBodies();
+  void reserveStepStorage();
+  void updateTransforms();
+  void computeBounds(float deltaTime);
+  void updateContacts(float deltaTime);
+  void addContact(int a, int b, const Manifold &manifold);
+  void buildIslands();
+  void solveContacts(float deltaTime);
+  void solveIsland(const Island &island, float deltaTime, FrameArena &arena);
+  void solveColoredIsland(const Island &island);
+  void runStage(SolverStage stage, int begin, int end);
+  void runColoredStage(SolverStage stage);
+  static void solveIslandsJob(void *context, int begin, int end, int worker);
+  static void stageJob(void *context, int begin, int end, int worker);
+  void updateSleep(float deltaTime);
+  void beginSweeps();
+  void solveContinuous();
+};
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+#include <chrono>
+
+// Step instrumentation. Build with PHYSICS_PROFILE defined to 0 to compile
+// every timer and counter out of the step; PhysicsWorld::profile() then
+// returns all zeros.
+#ifndef PHYSICS_PROFILE
+#define PHYSICS_PROFILE 1
+#endif
+
+#if PHYSICS_PROFILE
+#define PHYSICS_PROFILE_ONLY(statement) statement
+#else
+#define PHYSICS_PROFILE_ONLY(statement)
+#endif
+
+// What the last step did and where its time went. Times are wall time in
+// milliseconds. Integration runs island by island inside the solve, so its
+// time is part of solver.
+struct StepProfile
+{
+  double broadphase;
+  double narrowphase;
+  double islands;
+  double solver;
+  double continuous;
+  double sleep;
+  double total;
+
+  int candidatePairs;
+  int contacts;
+  int satAxesTested;
+  int awakeBodies;
+  int awakeIslands;
+  int islandCount;
+};
+
+// Measures the time between successive laps.
+class ProfileTimer
+{
+public:
+  ProfileTimer() : start(std::chrono::steady_clock::now()), last(start)
+  {
+  }
+
+  // Milliseconds since the previous lap, or since construction.
+  double lap()
+  {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double, std::milli>(now - last).count();
+    last = now;
+    return elapsed;
+  }
+
+  double total() const
+  {
+    return std::chrono::duration<double, std::milli>(last - start).count();
+  }
+
+private:
+  std::chrono::steady_clock::time_point start;
+  std::chrono::steady_clock::time_point last;
+};
+
+#endif
@@ -1,13 +1,7 @@
 #ifndef RIGID_BODY_H
 #define RIGID_BODY_H
-#include <glad/glad.h>
-#include <GLFW/glfw3.h>
-#include <map>
-#include <memory>
 #include <glm/glm/glm.hpp>
-#include <glm/glm/gtc/matrix_transform.hpp>
-#include "shader.h"
-#include "renderer.h"
+#include "collision.h"
 
 class RigidBody
 {
@@ -19,15 +13,27 @@ public:
   float height;
   float restitution = 0.5;
 
+  // A circle's width is its diameter. Call updateMassData after changing
+  // the shape.
+  ShapeType shape = ShapeType::Box;
+
   bool isStatic = false;
 
   float mass;
-  glm::vec2 forceVector;
-  glm::vec2 linearVelocity;
-  float torque;
-  float angularVelocity;
+  glm::vec2 forceVector = glm::vec2(0.0f, 0.0f);
+  glm::vec2 linearVelocity = glm::vec2(0.0f, 0.0f);
+  float torque = 0.0f;
+  float angularVelocity = 0.0f;
+
+  // Derived from mass, size and isStatic by updateMassData, which the
+  // constructor calls; call it again after changing any of those. Static
+  // bodies get zero inverses, so impulses and forces leave them alone.
+  float inverseMass;
+  float inertia;
+  float inverseInertia;
 
   RigidBody(glm::vec2 position, float rotation, float width, float height, float mass);
+  void updateMassData();
   void update(double deltaTime);
   void applyForce(glm::vec2 force, glm::vec2 point = glm::vec2(0.0f, 0.0f));
   void applyTorque(float torqueAdd);
@@ -0,0 +1,54 @@
+#ifndef SPATIAL_HASH_GRID_H
+#define SPATIAL_HASH_GRID_H
+#include <vector>
+#include "broadphase.h"
+
+// Uniform grid broadphase for scenes where bodies are all roughly the same
+// size. Cells are keyed by their integer coordinates in an open-addressing
+// hash table that is rebuilt every step; all storage is kept between steps
+// so a rebuild does not allocate once the scene stops growing.
+//
+// cellSize should be close to the size of a typical body. Bodies much larger
+// than a cell are still handled but are inserted into every cell they cover.
+class SpatialHashGrid : public Broadphase
+{
+public:
+  float cellSize;
+
+  SpatialHashGrid(float cellSize);
+
+  void findPairs(const std::vector<AABB> &bounds, std::vector<BodyPair> &pairs) override;
+  void query(const AABB &box, const std::vector<AABB> &bounds, std::vector<int> &bodies) const override;
+  // Makes room for bodies up to two cells across, which cover at most nine.
+  void reserve(int bodyCount) override;
+
+private:
+  struct Cell
+  {
+    int x;
+    int y;
+    int start;
+    int count;
+    unsigned int stamp;
+  };
+
+  struct Entry
+  {
+    int cell;
+    int body;
+  };
+
+  std::vector<Cell> cells;
+  std::vector<int> usedCells;
+  std::vector<Entry> entries;
+  std::vector<int> cellBodies;
+  unsigned int stamp = 0;
+
+  int cellCoordinate(float value) const;
+  int findCell(int x, int y) const;
+  int findOrInsertCell(int x, int y);
+  void growTable(int entryCount);
+  void prepareTable(int entryCount);
+};
+
+#endif
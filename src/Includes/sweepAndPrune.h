@@ -0,0 +1,36 @@
+#ifndef SWEEP_AND_PRUNE_H
+#define SWEEP_AND_PRUNE_H
+#include <vector>
+#include "broadphase.h"
+
+// Keeps the x-axis interval endpoints of every body sorted between steps.
+// Bodies move little from one step to the next, so re-sorting with an
+// insertion sort is close to linear, and a single sweep over the sorted
+// endpoints then reports every pair that also overlaps on y.
+class SweepAndPrune : public Broadphase
+{
+public:
+  struct Endpoint
+  {
+    float value;
+    int body;
+    bool isMin;
+  };
+
+  void findPairs(const std::vector<AABB> &bounds, std::vector<BodyPair> &pairs) override;
+  void query(const AABB &box, const std::vector<AABB> &bounds, std::vector<int> &bodies) const override;
+  void remapBodies(const std::vector<int> &newIndices, int bodyCount) override;
+  void reserve(int bodyCount) override;
+
+private:
+  std::vector<Endpoint> endpoints;
+  std::vector<int> active;
+  std::vector<unsigned char> trackedFlags;
+  int trackedBodies = 0;
+  bool unsorted = false;
+
+  void addBodies(const std::vector<AABB> &bounds);
+  void sortEndpoints();
+};
+
+#endif
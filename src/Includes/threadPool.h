@@ -0,0 +1,85 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include "frameArena.h"
+
+// Runs the items [begin, end) of a parallelFor. worker is the index of the
+// thread running it, for picking its arena.
+typedef void (*JobFunction)(void *context, int begin, int end, int worker);
+
+// Work-stealing pool of worker threads. Each worker owns a fixed-size queue
+// of jobs; it takes work from the back of its own queue and, once that is
+// empty, steals from the front of the others, so a few large jobs do not
+// leave the rest of the pool idle.
+//
+// Jobs are plain function pointers plus a context, so dispatching never
+// allocates. The thread calling parallelFor works as worker 0 until the
+// whole range is done; a pool of one worker runs everything inline.
+class ThreadPool
+{
+public:
+  // workerCount includes the calling thread. 0 uses one worker per core.
+  ThreadPool(int workerCount = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  int workerCount() const;
+
+  // Splits [0, count) into jobs of at most grainSize items and blocks until
+  // all of them have run.
+  void parallelFor(int count, int grainSize, JobFunction function, void *context);
+
+  // Scratch memory owned by one worker for the current step. Only that
+  // worker's jobs may allocate from it, though what they allocate may be
+  // read by any thread until resetArenas, which must not run alongside a
+  // parallelFor.
+  FrameArena &arena(int worker);
+  void resetArenas();
+  // Grows every worker's arena to at least capacity bytes; like
+  // FrameArena::reserve, only valid right after resetArenas.
+  void reserveArenas(size_t capacity);
+
+private:
+  struct Job
+  {
+    JobFunction function;
+    void *context;
+    int begin;
+    int end;
+  };
+
+  static const int queueCapacity = 256;
+
+  struct alignas(64) WorkerQueue
+  {
+    std::mutex mutex;
+    Job jobs[queueCapacity];
+    int head = 0;
+    int tail = 0;
+    FrameArena arena;
+  };
+
+  std::vector<std::unique_ptr<WorkerQueue>> queues;
+  std::vector<std::thread> threads;
+
+  std::mutex wakeMutex;
+  std::condition_variable wakeCondition;
+  unsigned int generation = 0;
+  bool stopping = false;
+  std::atomic<int> pendingJobs{0};
+
+  bool push(int worker, const Job &job);
+  bool pop(int worker, Job &job);
+  bool steal(int thief, Job &job);
+  bool runOne(int worker);
+  void workerLoop(int worker);
+};
+
+#endif
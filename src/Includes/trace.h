@@ -0,0 +1,63 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+// Scoped timers that record into per-thread ring buffers and can be written
+// out as Chrome trace JSON, for chrome://tracing or ui.perfetto.dev.
+//
+// TRACE_SCOPE(name) times the rest of the enclosing block under name, which
+// must be a string literal. Nothing is recorded unless tracing has been
+// started, and building with PHYSICS_TRACE defined to 0 compiles every scope
+// out.
+//
+// Each thread writes only to its own buffer, so recording takes no lock.
+// Buffers hold the most recent 65536 events of their thread; older ones are
+// overwritten. traceStart and traceWrite read every buffer, so call them
+// between steps, not while the world is stepping.
+#ifndef PHYSICS_TRACE
+#define PHYSICS_TRACE 1
+#endif
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#if PHYSICS_TRACE
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+#else
+#define TRACE_SCOPE(name)
+#endif
+
+// Drops everything recorded so far and starts recording.
+void traceStart();
+void traceStop();
+bool traceRecording();
+
+// Writes the events recorded since traceStart. Returns false if the file
+// could not be written.
+bool traceWrite(const char *path);
+
+// Nanoseconds on a steady clock.
+long long traceNow();
+void traceRecord(const char *name, long long start, long long end);
+
+class TraceScope
+{
+public:
+  explicit TraceScope(const char *name) : name(name), start(traceRecording() ? traceNow() : -1)
+  {
+  }
+
+  ~TraceScope()
+  {
+    if (start >= 0)
+      traceRecord(name, start, traceNow());
+  }
+
+  TraceScope(const TraceScope &) = delete;
+  TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+  const char *name;
+  long long start;
+};
+
+#endif
@@ -0,0 +1,591 @@
+#include "Includes/collision.h"
+#include <cfloat>
+#include <cmath>
+#include <algorithm>
+
+bool intervalsOverlap(float minA, float maxA, float minB, float maxB)
+{
+  return maxA >= minB && maxB >= minA;
+}
+
+float projectVertex(const glm::vec2 &vertex, const glm::vec2 &axis)
+{
+  return glm::dot(vertex, axis);
+}
+
+glm::vec2 computeEdgeNormal(const glm::vec2 &start, const glm::vec2 &end)
+{
+  glm::vec2 edgeNormal = glm::vec2(end.y - start.y, start.x - end.x);
+  if (glm::length(edgeNormal) == 0.0f)
+  {
+    return glm::vec2(0, 0);
+  }
+  return glm::normalize(edgeNormal);
+}
+
+// Positive rotation is counterclockwise, matching Renderer::drawSquare.
+// Corners are ordered top-left, top-right, bottom-right, bottom-left in local
+// space, and normals[i] belongs to the edge from vertices[i] to
+// vertices[i + 1]. The edge normals follow directly from the box axes, so no
+// normalisation is needed.
+BoxTransform computeBoxTransform(glm::vec2 position, float rotation, float width, float height)
+{
+  BoxTransform transform;
+
+  float angle = glm::radians(rotation);
+  float c = glm::cos(angle);
+  float s = glm::sin(angle);
+
+  transform.center = position;
+  transform.axisX = glm::vec2(c, s);
+  transform.axisY = glm::vec2(-s, c);
+  transform.halfExtents = glm::vec2(width / 2, height / 2);
+
+  glm::vec2 x = transform.axisX * transform.halfExtents.x;
+  glm::vec2 y = transform.axisY * transform.halfExtents.y;
+  transform.vertices[0] = position - x + y;
+  transform.vertices[1] = position + x + y;
+  transform.vertices[2] = position + x - y;
+  transform.vertices[3] = position - x - y;
+
+  glm::vec2 normalX = transform.halfExtents.x > 0.0f ? glm::vec2(transform.axisX.y, -transform.axisX.x) : glm::vec2(0.0f, 0.0f);
+  glm::vec2 normalY = transform.halfExtents.y > 0.0f ? glm::vec2(-transform.axisY.y, transform.axisY.x) : glm::vec2(0.0f, 0.0f);
+  transform.normals[0] = normalX;
+  transform.normals[1] = normalY;
+  transform.normals[2] = -normalX;
+  transform.normals[3] = -normalY;
+
+  return transform;
+}
+
+bool collidePolygons(const glm::vec2 *verticesA, const glm::vec2 *normalsA, int countA, glm::vec2 centerA,
+                     const glm::vec2 *verticesB, const glm::vec2 *normalsB, int countB, SatResult &result)
+{
+  result.overlap = FLT_MAX;
+
+  for (int j = 0; j < countA + countB; j++)
+  {
+    glm::vec2 axis = j < countA ? normalsA[j] : normalsB[j - countA];
+
+    if (axis == glm::vec2(0.0f, 0.0f))
+      continue;
+
+    float minA, maxA, minB, maxB;
+    minA = maxA = projectVertex(verticesA[0], axis);
+    for (int i = 1; i < countA; i++)
+    {
+      float projection = projectVertex(verticesA[i], axis);
+      minA = std::min(minA, projection);
+      maxA = std::max(maxA, projection);
+    }
+
+    minB = maxB = projectVertex(verticesB[0], axis);
+    for (int i = 1; i < countB; i++)
+    {
+      float projection = projectVertex(verticesB[i], axis);
+      minB = std::min(minB, projection);
+      maxB = std::max(maxB, projection);
+    }
+
+    if (!intervalsOverlap(minA, maxA, minB, maxB))
+    {
+      return false;
+    }
+
+    float overlapMin = std::max(minA, minB);
+    float overlapMax = std::min(maxA, maxB);
+
+    float overlap = std::max(0.0f, overlapMax - overlapMin);
+
+    if (overlap < result.overlap)
+    {
+      result.overlap = overlap;
+      result.axis = axis;
+      float overlapCenter = (overlapMin + overlapMax) / 2.0f;
+
+      result.contactPoint = centerA + (overlapCenter - glm::dot(centerA, axis)) * axis;
+    }
+  }
+
+  return true;
+}
+
+bool collideBoxes(const BoxTransform &a, const BoxTransform &b, SatResult &result)
+{
+  // The first two edge normals of a box are its two unique axes; the other
+  // two are the same axes negated.
+  const glm::vec2 axes[4] = {a.normals[0], a.normals[1], b.normals[0], b.normals[1]};
+
+  result.overlap = FLT_MAX;
+
+  for (int j = 0; j < 4; j++)
+  {
+    const glm::vec2 &axis = axes[j];
+
+    if (axis == glm::vec2(0.0f, 0.0f))
+      continue;
+
+    float centerA = glm::dot(a.center, axis);
+    float centerB = glm::dot(b.center, axis);
+    float radiusA = a.halfExtents.x * std::abs(glm::dot(a.axisX, axis)) + a.halfExtents.y * std::abs(glm::dot(a.axisY, axis));
+    float radiusB = b.halfExtents.x * std::abs(glm::dot(b.axisX, axis)) + b.halfExtents.y * std::abs(glm::dot(b.axisY, axis));
+
+    float overlapMin = std::max(centerA - radiusA, centerB - radiusB);
+    float overlapMax = std::min(centerA + radiusA, centerB + radiusB);
+
+    float overlap = overlapMax - overlapMin;
+    if (overlap < 0.0f)
+    {
+      return false;
+    }
+
+    if (overlap < result.overlap)
+    {
+      result.overlap = overlap;
+      result.axis = axis;
+
+      float overlapCenter = (overlapMin + overlapMax) / 2.0f;
+
+      result.contactPoint = a.center + (overlapCenter - centerA) * axis;
+    }
+  }
+
+  return true;
+}
+
+float boxSeparation(const BoxTransform &a, const BoxTransform &b)
+{
+  const glm::vec2 axes[4] = {a.axisX, a.axisY, b.axisX, b.axisY};
+  glm::vec2 offset = b.center - a.center;
+
+  float separation = -FLT_MAX;
+  for (const glm::vec2 &axis : axes)
+  {
+    float radiusA = a.halfExtents.x * std::abs(glm::dot(a.axisX, axis)) + a.halfExtents.y * std::abs(glm::dot(a.axisY, axis));
+    float radiusB = b.halfExtents.x * std::abs(glm::dot(b.axisX, axis)) + b.halfExtents.y * std::abs(glm::dot(b.axisY, axis));
+    separation = std::max(separation, std::abs(glm::dot(offset, axis)) - radiusA - radiusB);
+  }
+  return separation;
+}
+
+// A center inside the box is as far inside as the nearest face.
+static float boxCircleSeparation(const BoxTransform &box, glm::vec2 center, float radius)
+{
+  glm::vec2 offset = center - box.center;
+  glm::vec2 local = glm::vec2(glm::dot(box.axisX, offset), glm::dot(box.axisY, offset));
+  glm::vec2 clamped = glm::clamp(local, -box.halfExtents, box.halfExtents);
+  if (clamped != local)
+    return glm::length(local - clamped) - radius;
+
+  glm::vec2 depth = box.halfExtents - glm::abs(local);
+  return -std::min(depth.x, depth.y) - radius;
+}
+
+float shapeSeparation(const BoxTransform &a, ShapeType shapeA, const BoxTransform &b, ShapeType shapeB)
+{
+  if (shapeA == ShapeType::Box && shapeB == ShapeType::Box)
+    return boxSeparation(a, b);
+  if (shapeA == ShapeType::Circle && shapeB == ShapeType::Circle)
+    return glm::length(b.center - a.center) - a.halfExtents.x - b.halfExtents.x;
+  if (shapeA == ShapeType::Box)
+    return boxCircleSeparation(a, b.center, b.halfExtents.x);
+  return boxCircleSeparation(b, a.center, a.halfExtents.x);
+}
+
+float timeOfImpact(glm::vec2 startPosition, float startRotation, glm::vec2 endPosition, float endRotation,
+                   float width, float height, ShapeType shape, const BoxTransform &b, ShapeType shapeB, float target)
+{
+  const int maxIterations = 30;
+
+  glm::vec2 translation = endPosition - startPosition;
+  float turn = endRotation - startRotation;
+  float radius = shape == ShapeType::Circle ? 0.0f : 0.5f * std::sqrt(width * width + height * height);
+  float motionBound = glm::length(translation) + std::abs(glm::radians(turn)) * radius;
+  if (motionBound <= 0.0f)
+    return 1.0f;
+
+  float tolerance = 0.25f * std::abs(target) + 0.01f;
+  float time = 0.0f;
+  for (int i = 0; i < maxIterations; i++)
+  {
+    BoxTransform a = computeBoxTransform(startPosition + translation * time, startRotation + turn * time, width, height);
+    float separation = shapeSeparation(a, shape, b, shapeB);
+    if (separation <= target + tolerance)
+      return time;
+
+    time += (separation - target) / motionBound;
+    if (time >= 1.0f)
+      return 1.0f;
+  }
+
+  return time;
+}
+
+// Box edges, numbered counterclockwise from the top:
+//
+//        e1
+//   v2 ------ v1
+//    |        |
+// e2 |        | e4
+//    |        |
+//   v3 ------ v4
+//        e3
+enum BoxEdge
+{
+  NO_EDGE = 0,
+  EDGE1,
+  EDGE2,
+  EDGE3,
+  EDGE4
+};
+
+struct FeaturePair
+{
+  unsigned char inEdge1;
+  unsigned char outEdge1;
+  unsigned char inEdge2;
+  unsigned char outEdge2;
+};
+
+struct ClipVertex
+{
+  glm::vec2 position;
+  FeaturePair feature;
+};
+
+static unsigned int packFeature(const FeaturePair &feature)
+{
+  return feature.inEdge1 | feature.outEdge1 << 8 | feature.inEdge2 << 16 | static_cast<unsigned int>(feature.outEdge2) << 24;
+}
+
+static void flipFeature(FeaturePair &feature)
+{
+  std::swap(feature.inEdge1, feature.inEdge2);
+  std::swap(feature.outEdge1, feature.outEdge2);
+}
+
+static int clipSegmentToLine(ClipVertex out[2], const ClipVertex in[2], glm::vec2 normal, float offset, unsigned char clipEdge)
+{
+  int count = 0;
+
+  float distance0 = glm::dot(normal, in[0].position) - offset;
+  float distance1 = glm::dot(normal, in[1].position) - offset;
+
+  if (distance0 <= 0.0f)
+    out[count++] = in[0];
+  if (distance1 <= 0.0f)
+    out[count++] = in[1];
+
+  if (distance0 * distance1 < 0.0f)
+  {
+    float interpolation = distance0 / (distance0 - distance1);
+    out[count].position = in[0].position + interpolation * (in[1].position - in[0].position);
+    if (distance0 > 0.0f)
+    {
+      out[count].feature = in[0].feature;
+      out[count].feature.inEdge1 = clipEdge;
+      out[count].feature.inEdge2 = NO_EDGE;
+    }
+    else
+    {
+      out[count].feature = in[1].feature;
+      out[count].feature.outEdge1 = clipEdge;
+      out[count].feature.outEdge2 = NO_EDGE;
+    }
+    count++;
+  }
+
+  return count;
+}
+
+// Finds the edge of box whose normal is most anti-parallel to normal.
+static void computeIncidentEdge(ClipVertex edge[2], const BoxTransform &box, glm::vec2 normal)
+{
+  glm::vec2 h = box.halfExtents;
+  glm::vec2 n = -glm::vec2(glm::dot(box.axisX, normal), glm::dot(box.axisY, normal));
+  glm::vec2 nAbs = glm::abs(n);
+
+  glm::vec2 local0, local1;
+  if (nAbs.x > nAbs.y)
+  {
+    if (n.x > 0.0f)
+    {
+      local0 = glm::vec2(h.x, -h.y);
+      edge[0].feature = FeaturePair{NO_EDGE, NO_EDGE, EDGE3, EDGE4};
+      local1 = glm::vec2(h.x, h.y);
+      edge[1].feature = FeaturePair{NO_EDGE, NO_EDGE, EDGE4, EDGE1};
+    }
+    else
+    {
+      local0 = glm::vec2(-h.x, h.y);
+      edge[0].feature = FeaturePair{NO_EDGE, NO_EDGE, EDGE1, EDGE2};
+      local1 = glm::vec2(-h.x, -h.y);
+      edge[1].feature = FeaturePair{NO_EDGE, NO_EDGE, EDGE2, EDGE3};
+    }
+  }
+  else
+  {
+    if (n.y > 0.0f)
+    {
+      local0 = glm::vec2(h.x, h.y);
+      edge[0].feature = FeaturePair{NO_EDGE, NO_EDGE, EDGE4, EDGE1};
+      local1 = glm::vec2(-h.x, h.y);
+      edge[1].feature = FeaturePair{NO_EDGE, NO_EDGE, EDGE1, EDGE2};
+    }
+    else
+    {
+      local0 = glm::vec2(-h.x, -h.y);
+      edge[0].feature = FeaturePair{NO_EDGE, NO_EDGE, EDGE2, EDGE3};
+      local1 = glm::vec2(h.x, -h.y);
+      edge[1].feature = FeaturePair{NO_EDGE, NO_EDGE, EDGE3, EDGE4};
+    }
+  }
+
+  edge[0].position = box.center + box.axisX * local0.x + box.axisY * local0.y;
+  edge[1].position = box.center + box.axisX * local1.x + box.axisY * local1.y;
+}
+
+// Raises a separation by the tolerance used to choose the reference face,
+// whichever side of zero it is on.
+static float faceTolerance(float separation, float relativeTolerance)
+{
+  return separation + (1.0f - relativeTolerance) * std::abs(separation);
+}
+
+int collideBoxesManifold(const BoxTransform &a, const BoxTransform &b, Manifold &manifold, float speculativeDistance)
+{
+  manifold.pointCount = 0;
+
+  glm::vec2 offset = b.center - a.center;
+  glm::vec2 offsetA = glm::vec2(glm::dot(a.axisX, offset), glm::dot(a.axisY, offset));
+  glm::vec2 offsetB = glm::vec2(glm::dot(b.axisX, offset), glm::dot(b.axisY, offset));
+
+  // Rotation of B relative to A, and its absolute value for projecting the
+  // half extents of one box onto the axes of the other.
+  float c11 = std::abs(glm::dot(a.axisX, b.axisX));
+  float c12 = std::abs(glm::dot(a.axisX, b.axisY));
+  float c21 = std::abs(glm::dot(a.axisY, b.axisX));
+  float c22 = std::abs(glm::dot(a.axisY, b.axisY));
+
+  glm::vec2 faceA = glm::abs(offsetA) - a.halfExtents - glm::vec2(c11 * b.halfExtents.x + c12 * b.halfExtents.y, c21 * b.halfExtents.x + c22 * b.halfExtents.y);
+  if (faceA.x > speculativeDistance || faceA.y > speculativeDistance)
+    return 0;
+
+  glm::vec2 faceB = glm::abs(offsetB) - glm::vec2(c11 * a.halfExtents.x + c21 * a.halfExtents.y, c12 * a.halfExtents.x + c22 * a.halfExtents.y) - b.halfExtents;
+  if (faceB.x > speculativeDistance || faceB.y > speculativeDistance)
+    return 0;
+
+  const float relativeTolerance = 0.95f;
+  const float absoluteTolerance = 0.01f;
+
+  enum
+  {
+    FACE_A_X,
+    FACE_A_Y,
+    FACE_B_X,
+    FACE_B_Y
+  } axis = FACE_A_X;
+
+  float separation = faceA.x;
+  glm::vec2 normal = offsetA.x > 0.0f ? a.axisX : -a.axisX;
+
+  if (faceA.y > faceTolerance(separation, relativeTolerance) + absoluteTolerance * a.halfExtents.y)
+  {
+    axis = FACE_A_Y;
+    separation = faceA.y;
+    normal = offsetA.y > 0.0f ? a.axisY : -a.axisY;
+  }
+
+  if (faceB.x > faceTolerance(separation, relativeTolerance) + absoluteTolerance * b.halfExtents.x)
+  {
+    axis = FACE_B_X;
+    separation = faceB.x;
+    normal = offsetB.x > 0.0f ? b.axisX : -b.axisX;
+  }
+
+  if (faceB.y > faceTolerance(separation, relativeTolerance) + absoluteTolerance * b.halfExtents.y)
+  {
+    axis = FACE_B_Y;
+    separation = faceB.y;
+    normal = offsetB.y > 0.0f ? b.axisY : -b.axisY;
+  }
+
+  glm::vec2 frontNormal, sideNormal;
+  ClipVertex incidentEdge[2];
+  float front, negativeSide, positiveSide;
+  unsigned char negativeEdge, positiveEdge;
+
+  switch (axis)
+  {
+  case FACE_A_X:
+  {
+    frontNormal = normal;
+    front = glm::dot(a.center, frontNormal) + a.halfExtents.x;
+    sideNormal = a.axisY;
+    float side = glm::dot(a.center, sideNormal);
+    negativeSide = -side + a.halfExtents.y;
+    positiveSide = side + a.halfExtents.y;
+    negativeEdge = EDGE3;
+    positiveEdge = EDGE1;
+    computeIncidentEdge(incidentEdge, b, frontNormal);
+    break;
+  }
+  case FACE_A_Y:
+  {
+    frontNormal = normal;
+    front = glm::dot(a.center, frontNormal) + a.halfExtents.y;
+    sideNormal = a.axisX;
+    float side = glm::dot(a.center, sideNormal);
+    negativeSide = -side + a.halfExtents.x;
+    positiveSide = side + a.halfExtents.x;
+    negativeEdge = EDGE2;
+    positiveEdge = EDGE4;
+    computeIncidentEdge(incidentEdge, b, frontNormal);
+    break;
+  }
+  case FACE_B_X:
+  {
+    frontNormal = -normal;
+    front = glm::dot(b.center, frontNormal) + b.halfExtents.x;
+    sideNormal = b.axisY;
+    float side = glm::dot(b.center, sideNormal);
+    negativeSide = -side + b.halfExtents.y;
+    positiveSide = side + b.halfExtents.y;
+    negativeEdge = EDGE3;
+    positiveEdge = EDGE1;
+    computeIncidentEdge(incidentEdge, a, frontNormal);
+    break;
+  }
+  default:
+  {
+    frontNormal = -normal;
+    front = glm::dot(b.center, frontNormal) + b.halfExtents.y;
+    sideNormal = b.axisX;
+    float side = glm::dot(b.center, sideNormal);
+    negativeSide = -side + b.halfExtents.x;
+    positiveSide = side + b.halfExtents.x;
+    negativeEdge = EDGE2;
+    positiveEdge = EDGE4;
+    computeIncidentEdge(incidentEdge, a, frontNormal);
+    break;
+  }
+  }
+
+  ClipVertex clipPoints1[2];
+  ClipVertex clipPoints2[2];
+
+  if (clipSegmentToLine(clipPoints1, incidentEdge, -sideNormal, negativeSide, negativeEdge) < 2)
+    return 0;
+
+  if (clipSegmentToLine(clipPoints2, clipPoints1, sideNormal, positiveSide, positiveEdge) < 2)
+    return 0;
+
+  manifold.normal = normal;
+
+  for (int i = 0; i < 2; i++)
+  {
+    float pointSeparation = glm::dot(frontNormal, clipPoints2[i].position) - front;
+    if (pointSeparation > speculativeDistance)
+      continue;
+
+    // Slide the point onto the reference face so both boxes agree on it.
+    ContactPoint &point = manifold.points[manifold.pointCount++];
+    point.separation = pointSeparation;
+    point.position = clipPoints2[i].position - pointSeparation * frontNormal;
+    point.normalImpulse = 0.0f;
+    point.tangentImpulse = 0.0f;
+
+    FeaturePair feature = clipPoints2[i].feature;
+    if (axis == FACE_B_X || axis == FACE_B_Y)
+    {
+      flipFeature(feature);
+    }
+    point.id = packFeature(feature);
+  }
+
+  return manifold.pointCount;
+}
+
+static int singlePointManifold(Manifold &manifold, glm::vec2 normal, glm::vec2 position, float separation)
+{
+  manifold.normal = normal;
+  manifold.pointCount = 1;
+
+  ContactPoint &point = manifold.points[0];
+  point.position = position;
+  point.separation = separation;
+  point.id = 0;
+  point.normalImpulse = 0.0f;
+  point.tangentImpulse = 0.0f;
+  return 1;
+}
+
+int collideCirclesManifold(glm::vec2 centerA, float radiusA, glm::vec2 centerB, float radiusB, Manifold &manifold, float speculativeDistance)
+{
+  manifold.pointCount = 0;
+
+  glm::vec2 offset = centerB - centerA;
+  float reach = radiusA + radiusB + speculativeDistance;
+  float distanceSquared = glm::dot(offset, offset);
+  if (distanceSquared > reach * reach)
+    return 0;
+
+  // Coincident centers have no direction between them; push along y.
+  float distance = std::sqrt(distanceSquared);
+  glm::vec2 normal = distance > 0.0f ? offset / distance : glm::vec2(0.0f, 1.0f);
+
+  glm::vec2 surfaceA = centerA + normal * radiusA;
+  glm::vec2 surfaceB = centerB - normal * radiusB;
+  return singlePointManifold(manifold, normal, 0.5f * (surfaceA + surfaceB), distance - radiusA - radiusB);
+}
+
+int collideBoxCircleManifold(const BoxTransform &box, glm::vec2 center, float radius, Manifold &manifold, float speculativeDistance)
+{
+  manifold.pointCount = 0;
+
+  glm::vec2 offset = center - box.center;
+  glm::vec2 local = glm::vec2(glm::dot(box.axisX, offset), glm::dot(box.axisY, offset));
+  glm::vec2 h = box.halfExtents;
+
+  glm::vec2 faces = glm::abs(local) - h - glm::vec2(radius);
+  if (faces.x > speculativeDistance || faces.y > speculativeDistance)
+    return 0;
+
+  glm::vec2 clamped = glm::clamp(local, -h, h);
+  glm::vec2 normal;
+  float separation;
+
+  if (clamped != local)
+  {
+    // Outside: the closest point of the box is the clamped center.
+    glm::vec2 gap = local - clamped;
+    float distance = glm::length(gap);
+    separation = distance - radius;
+    if (separation > speculativeDistance)
+      return 0;
+
+    gap /= distance;
+    normal = box.axisX * gap.x + box.axisY * gap.y;
+  }
+  else
+  {
+    // Inside: out through the face the center is nearest to.
+    glm::vec2 depth = h - glm::abs(local);
+    if (depth.x < depth.y)
+    {
+      normal = local.x >= 0.0f ? box.axisX : -box.axisX;
+      clamped.x = local.x >= 0.0f ? h.x : -h.x;
+      separation = -depth.x - radius;
+    }
+    else
+    {
+      normal = local.y >= 0.0f ? box.axisY : -box.axisY;
+      clamped.y = local.y >= 0.0f ? h.y : -h.y;
+      separation = -depth.y - radius;
+    }
+  }
+
+  glm::vec2 surfaceBox = box.center + box.axisX * clamped.x + box.axisY * clamped.y;
+  glm::vec2 surfaceCircle = center - normal * radius;
+  return singlePointManifold(manifold, normal, 0.5f * (surfaceBox + surfaceCircle), separation);
+}
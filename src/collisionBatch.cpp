@@ -0,0 +1,283 @@
+#include "Includes/collision.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define PHYSICS_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(PHYSICS_X86) && (defined(__GNUC__) || defined(__clang__))
+#define PHYSICS_TARGET_SSE __attribute__((target("sse4.1")))
+#define PHYSICS_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define PHYSICS_TARGET_SSE
+#define PHYSICS_TARGET_AVX2
+#endif
+
+// Pair data transposed so each field of a group of pairs sits in one
+// contiguous lane array. Each box contributes its center, its two axes and
+// its half extents.
+template <int Lanes>
+struct PairLanes
+{
+  float centerAX[Lanes], centerAY[Lanes], axisXAX[Lanes], axisXAY[Lanes], axisYAX[Lanes], axisYAY[Lanes], halfAX[Lanes], halfAY[Lanes];
+  float centerBX[Lanes], centerBY[Lanes], axisXBX[Lanes], axisXBY[Lanes], axisYBX[Lanes], axisYBY[Lanes], halfBX[Lanes], halfBY[Lanes];
+};
+
+template <int Lanes>
+static void gatherPairs(const BoxTransform *transforms, const BodyPair *pairs, int count, PairLanes<Lanes> &lanes)
+{
+  for (int i = 0; i < Lanes; i++)
+  {
+    // Short groups repeat the last pair; the extra lanes are never stored.
+    const BodyPair &pair = pairs[std::min(i, count - 1)];
+    const BoxTransform &a = transforms[pair.a];
+    const BoxTransform &b = transforms[pair.b];
+
+    lanes.centerAX[i] = a.center.x;
+    lanes.centerAY[i] = a.center.y;
+    lanes.axisXAX[i] = a.axisX.x;
+    lanes.axisXAY[i] = a.axisX.y;
+    lanes.axisYAX[i] = a.axisY.x;
+    lanes.axisYAY[i] = a.axisY.y;
+    lanes.halfAX[i] = a.halfExtents.x;
+    lanes.halfAY[i] = a.halfExtents.y;
+
+    lanes.centerBX[i] = b.center.x;
+    lanes.centerBY[i] = b.center.y;
+    lanes.axisXBX[i] = b.axisX.x;
+    lanes.axisXBY[i] = b.axisX.y;
+    lanes.axisYBX[i] = b.axisY.x;
+    lanes.axisYBY[i] = b.axisY.y;
+    lanes.halfBX[i] = b.halfExtents.x;
+    lanes.halfBY[i] = b.halfExtents.y;
+  }
+}
+
+template <int Lanes>
+static void scatterResults(const float *overlap, const float *axisX, const float *axisY, const float *contactOffset,
+                           const PairLanes<Lanes> &lanes, int count, SatResult *results)
+{
+  for (int i = 0; i < std::min(count, Lanes); i++)
+  {
+    results[i].overlap = overlap[i];
+    results[i].axis = glm::vec2(axisX[i], axisY[i]);
+    results[i].contactPoint = glm::vec2(lanes.centerAX[i], lanes.centerAY[i]) + contactOffset[i] * results[i].axis;
+  }
+}
+
+// The axes tested are a box's first two edge normals, which are its axisY and
+// axisX negated, in the same order collideBoxes uses.
+static void collideBoxesBatchScalar(const BoxTransform *transforms, const BodyPair *pairs, int count, SatResult *results)
+{
+  for (int i = 0; i < count; i++)
+  {
+    const BoxTransform &a = transforms[pairs[i].a];
+    const BoxTransform &b = transforms[pairs[i].b];
+    const glm::vec2 axes[4] = {-a.axisY, -a.axisX, -b.axisY, -b.axisX};
+
+    SatResult &result = results[i];
+    result.overlap = INFINITY;
+
+    for (int j = 0; j < 4; j++)
+    {
+      const glm::vec2 &axis = axes[j];
+
+      float centerA = glm::dot(a.center, axis);
+      float centerB = glm::dot(b.center, axis);
+      float radiusA = a.halfExtents.x * std::abs(glm::dot(a.axisX, axis)) + a.halfExtents.y * std::abs(glm::dot(a.axisY, axis));
+      float radiusB = b.halfExtents.x * std::abs(glm::dot(b.axisX, axis)) + b.halfExtents.y * std::abs(glm::dot(b.axisY, axis));
+
+      float overlapMin = std::max(centerA - radiusA, centerB - radiusB);
+      float overlapMax = std::min(centerA + radiusA, centerB + radiusB);
+      float overlap = overlapMax - overlapMin;
+
+      if (overlap < result.overlap)
+      {
+        result.overlap = overlap;
+        result.axis = axis;
+        result.contactPoint = a.center + ((overlapMin + overlapMax) / 2.0f - centerA) * axis;
+      }
+    }
+  }
+}
+
+#ifdef PHYSICS_X86
+
+PHYSICS_TARGET_SSE static inline __m128 absSSE(__m128 value)
+{
+  return _mm_andnot_ps(_mm_set1_ps(-0.0f), value);
+}
+
+PHYSICS_TARGET_SSE static void collideBoxesBatchSSE(const BoxTransform *transforms, const BodyPair *pairs, int count, SatResult *results)
+{
+  PairLanes<4> lanes;
+  alignas(16) float overlapOut[4], axisXOut[4], axisYOut[4], offsetOut[4];
+
+  for (int first = 0; first < count; first += 4)
+  {
+    int groupCount = std::min(4, count - first);
+    gatherPairs<4>(transforms, pairs + first, groupCount, lanes);
+
+    __m128 cAX = _mm_loadu_ps(lanes.centerAX), cAY = _mm_loadu_ps(lanes.centerAY);
+    __m128 xAX = _mm_loadu_ps(lanes.axisXAX), xAY = _mm_loadu_ps(lanes.axisXAY);
+    __m128 yAX = _mm_loadu_ps(lanes.axisYAX), yAY = _mm_loadu_ps(lanes.axisYAY);
+    __m128 hAX = _mm_loadu_ps(lanes.halfAX), hAY = _mm_loadu_ps(lanes.halfAY);
+    __m128 cBX = _mm_loadu_ps(lanes.centerBX), cBY = _mm_loadu_ps(lanes.centerBY);
+    __m128 xBX = _mm_loadu_ps(lanes.axisXBX), xBY = _mm_loadu_ps(lanes.axisXBY);
+    __m128 yBX = _mm_loadu_ps(lanes.axisYBX), yBY = _mm_loadu_ps(lanes.axisYBY);
+    __m128 hBX = _mm_loadu_ps(lanes.halfBX), hBY = _mm_loadu_ps(lanes.halfBY);
+
+    __m128 zero = _mm_setzero_ps();
+    const __m128 axesX[4] = {_mm_sub_ps(zero, yAX), _mm_sub_ps(zero, xAX), _mm_sub_ps(zero, yBX), _mm_sub_ps(zero, xBX)};
+    const __m128 axesY[4] = {_mm_sub_ps(zero, yAY), _mm_sub_ps(zero, xAY), _mm_sub_ps(zero, yBY), _mm_sub_ps(zero, xBY)};
+
+    __m128 bestOverlap = _mm_set1_ps(INFINITY);
+    __m128 bestAxisX = zero, bestAxisY = zero, bestOffset = zero;
+
+    for (int j = 0; j < 4; j++)
+    {
+      __m128 lx = axesX[j], ly = axesY[j];
+
+      __m128 centerA = _mm_add_ps(_mm_mul_ps(cAX, lx), _mm_mul_ps(cAY, ly));
+      __m128 centerB = _mm_add_ps(_mm_mul_ps(cBX, lx), _mm_mul_ps(cBY, ly));
+      __m128 radiusA = _mm_add_ps(_mm_mul_ps(hAX, absSSE(_mm_add_ps(_mm_mul_ps(xAX, lx), _mm_mul_ps(xAY, ly)))),
+                                  _mm_mul_ps(hAY, absSSE(_mm_add_ps(_mm_mul_ps(yAX, lx), _mm_mul_ps(yAY, ly)))));
+      __m128 radiusB = _mm_add_ps(_mm_mul_ps(hBX, absSSE(_mm_add_ps(_mm_mul_ps(xBX, lx), _mm_mul_ps(xBY, ly)))),
+                                  _mm_mul_ps(hBY, absSSE(_mm_add_ps(_mm_mul_ps(yBX, lx), _mm_mul_ps(yBY, ly)))));
+
+      __m128 overlapMin = _mm_max_ps(_mm_sub_ps(centerA, radiusA), _mm_sub_ps(centerB, radiusB));
+      __m128 overlapMax = _mm_min_ps(_mm_add_ps(centerA, radiusA), _mm_add_ps(centerB, radiusB));
+      __m128 overlap = _mm_sub_ps(overlapMax, overlapMin);
+      __m128 offset = _mm_sub_ps(_mm_mul_ps(_mm_add_ps(overlapMin, overlapMax), _mm_set1_ps(0.5f)), centerA);
+
+      __m128 better = _mm_cmplt_ps(overlap, bestOverlap);
+      bestOverlap = _mm_blendv_ps(bestOverlap, overlap, better);
+      bestAxisX = _mm_blendv_ps(bestAxisX, lx, better);
+      bestAxisY = _mm_blendv_ps(bestAxisY, ly, better);
+      bestOffset = _mm_blendv_ps(bestOffset, offset, better);
+    }
+
+    _mm_store_ps(overlapOut, bestOverlap);
+    _mm_store_ps(axisXOut, bestAxisX);
+    _mm_store_ps(axisYOut, bestAxisY);
+    _mm_store_ps(offsetOut, bestOffset);
+    scatterResults<4>(overlapOut, axisXOut, axisYOut, offsetOut, lanes, groupCount, results + first);
+  }
+}
+
+PHYSICS_TARGET_AVX2 static inline __m256 absAVX(__m256 value)
+{
+  return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), value);
+}
+
+PHYSICS_TARGET_AVX2 static void collideBoxesBatchAVX2(const BoxTransform *transforms, const BodyPair *pairs, int count, SatResult *results)
+{
+  PairLanes<8> lanes;
+  alignas(32) float overlapOut[8], axisXOut[8], axisYOut[8], offsetOut[8];
+
+  for (int first = 0; first < count; first += 8)
+  {
+    int groupCount = std::min(8, count - first);
+    gatherPairs<8>(transforms, pairs + first, groupCount, lanes);
+
+    __m256 cAX = _mm256_loadu_ps(lanes.centerAX), cAY = _mm256_loadu_ps(lanes.centerAY);
+    __m256 xAX = _mm256_loadu_ps(lanes.axisXAX), xAY = _mm256_loadu_ps(lanes.axisXAY);
+    __m256 yAX = _mm256_loadu_ps(lanes.axisYAX), yAY = _mm256_loadu_ps(lanes.axisYAY);
+    __m256 hAX = _mm256_loadu_ps(lanes.halfAX), hAY = _mm256_loadu_ps(lanes.halfAY);
+    __m256 cBX = _mm256_loadu_ps(lanes.centerBX), cBY = _mm256_loadu_ps(lanes.centerBY);
+    __m256 xBX = _mm256_loadu_ps(lanes.axisXBX), xBY = _mm256_loadu_ps(lanes.axisXBY);
+    __m256 yBX = _mm256_loadu_ps(lanes.axisYBX), yBY = _mm256_loadu_ps(lanes.axisYBY);
+    __m256 hBX = _mm256_loadu_ps(lanes.halfBX), hBY = _mm256_loadu_ps(lanes.halfBY);
+
+    __m256 zero = _mm256_setzero_ps();
+    const __m256 axesX[4] = {_mm256_sub_ps(zero, yAX), _mm256_sub_ps(zero, xAX), _mm256_sub_ps(zero, yBX), _mm256_sub_ps(zero, xBX)};
+    const __m256 axesY[4] = {_mm256_sub_ps(zero, yAY), _mm256_sub_ps(zero, xAY), _mm256_sub_ps(zero, yBY), _mm256_sub_ps(zero, xBY)};
+
+    __m256 bestOverlap = _mm256_set1_ps(INFINITY);
+    __m256 bestAxisX = zero, bestAxisY = zero, bestOffset = zero;
+
+    for (int j = 0; j < 4; j++)
+    {
+      __m256 lx = axesX[j], ly = axesY[j];
+
+      __m256 centerA = _mm256_add_ps(_mm256_mul_ps(cAX, lx), _mm256_mul_ps(cAY, ly));
+      __m256 centerB = _mm256_add_ps(_mm256_mul_ps(cBX, lx), _mm256_mul_ps(cBY, ly));
+      __m256 radiusA = _mm256_add_ps(_mm256_mul_ps(hAX, absAVX(_mm256_add_ps(_mm256_mul_ps(xAX, lx), _mm256_mul_ps(xAY, ly)))),
+                                     _mm256_mul_ps(hAY, absAVX(_mm256_add_ps(_mm256_mul_ps(yAX, lx), _mm256_mul_ps(yAY, ly)))));
+      __m256 radiusB = _mm256_add_ps(_mm256_mul_ps(hBX, absAVX(_mm256_add_ps(_mm256_mul_ps(xBX, lx), _mm256_mul_ps(xBY, ly)))),
+                                     _mm256_mul_ps(hBY, absAVX(_mm256_add_ps(_mm256_mul_ps(yBX, lx), _mm256_mul_ps(yBY, ly)))));
+
+      __m256 overlapMin = _mm256_max_ps(_mm256_sub_ps(centerA, radiusA), _mm256_sub_ps(centerB, radiusB));
+      __m256 overlapMax = _mm256_min_ps(_mm256_add_ps(centerA, radiusA), _mm256_add_ps(centerB, radiusB));
+      __m256 overlap = _mm256_sub_ps(overlapMax, overlapMin);
+      __m256 offset = _mm256_sub_ps(_mm256_mul_ps(_mm256_add_ps(overlapMin, overlapMax), _mm256_set1_ps(0.5f)), centerA);
+
+      __m256 better = _mm256_cmp_ps(overlap, bestOverlap, _CMP_LT_OQ);
+      bestOverlap = _mm256_blendv_ps(bestOverlap, overlap, better);
+      bestAxisX = _mm256_blendv_ps(bestAxisX, lx, better);
+      bestAxisY = _mm256_blendv_ps(bestAxisY, ly, better);
+      bestOffset = _mm256_blendv_ps(bestOffset, offset, better);
+    }
+
+    _mm256_store_ps(overlapOut, bestOverlap);
+    _mm256_store_ps(axisXOut, bestAxisX);
+    _mm256_store_ps(axisYOut, bestAxisY);
+    _mm256_store_ps(offsetOut, bestOffset);
+    scatterResults<8>(overlapOut, axisXOut, axisYOut, offsetOut, lanes, groupCount, results + first);
+  }
+}
+
+#endif
+
+SimdLevel detectSimdLevel()
+{
+#if defined(PHYSICS_X86) && (defined(__GNUC__) || defined(__clang__))
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return SimdLevel::AVX2;
+  if (__builtin_cpu_supports("sse4.1"))
+    return SimdLevel::SSE;
+#elif defined(PHYSICS_X86) && defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 1);
+  bool sse41 = (info[2] & (1 << 19)) != 0;
+  bool osSavesAvx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+  __cpuidex(info, 7, 0);
+  if (osSavesAvx && (info[1] & (1 << 5)) != 0)
+    return SimdLevel::AVX2;
+  if (sse41)
+    return SimdLevel::SSE;
+#endif
+  return SimdLevel::Scalar;
+}
+
+void collideBoxesBatch(const BoxTransform *transforms, const BodyPair *pairs, int count, SatResult *results, SimdLevel level)
+{
+  if (count <= 0)
+    return;
+
+#ifdef PHYSICS_X86
+  if (level == SimdLevel::AVX2)
+  {
+    collideBoxesBatchAVX2(transforms, pairs, count, results);
+    return;
+  }
+  if (level == SimdLevel::SSE)
+  {
+    collideBoxesBatchSSE(transforms, pairs, count, results);
+    return;
+  }
+#endif
+  collideBoxesBatchScalar(transforms, pairs, count, results);
+}
+
+void collideBoxesBatch(const BoxTransform *transforms, const BodyPair *pairs, int count, SatResult *results)
+{
+  static const SimdLevel level = detectSimdLevel();
+  collideBoxesBatch(transforms, pairs, count, results, level);
+}
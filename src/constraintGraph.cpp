@@ -0,0 +1,71 @@
+#include "Includes/constraintGraph.h"
+
+void ConstraintGraph::reserve(int bodyCount, int contactCount)
+{
+  bodyColors.reserve(bodyCount);
+  contactColors.reserve(contactCount);
+  sorted.reserve(contactCount);
+}
+
+void ConstraintGraph::color(const std::vector<unsigned char> &staticFlags, std::vector<Contact> &contacts, int begin, int end)
+{
+  int count = end - begin;
+  if (bodyColors.size() < staticFlags.size())
+  {
+    bodyColors.resize(staticFlags.size(), 0);
+  }
+  contactColors.resize(count);
+
+  int colorCounts[maxColors + 1] = {};
+  for (int i = 0; i < count; i++)
+  {
+    int a = contacts[begin + i].a;
+    int b = contacts[begin + i].b;
+    unsigned int used = (staticFlags[a] ? 0u : bodyColors[a]) | (staticFlags[b] ? 0u : bodyColors[b]);
+
+    int color = 0;
+    while (color < maxColors && (used & (1u << color)))
+    {
+      color++;
+    }
+
+    if (color < maxColors)
+    {
+      if (!staticFlags[a])
+        bodyColors[a] |= 1u << color;
+      if (!staticFlags[b])
+        bodyColors[b] |= 1u << color;
+    }
+
+    contactColors[i] = color;
+    colorCounts[color]++;
+  }
+
+  // Leave the masks clear for the next island.
+  for (int i = begin; i < end; i++)
+  {
+    bodyColors[contacts[i].a] = 0;
+    bodyColors[contacts[i].b] = 0;
+  }
+
+  int offset = begin;
+  for (int c = 0; c <= maxColors; c++)
+  {
+    colorStarts[c] = offset;
+    offset += colorCounts[c];
+    colorCounts[c] = 0;
+  }
+  colorStarts[maxColors + 1] = offset;
+
+  sorted.resize(count);
+  for (int i = 0; i < count; i++)
+  {
+    int color = contactColors[i];
+    sorted[colorStarts[color] - begin + colorCounts[color]++] = contacts[begin + i];
+  }
+
+  for (int i = 0; i < count; i++)
+  {
+    contacts[begin + i] = sorted[i];
+  }
+}
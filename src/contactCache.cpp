@@ -0,0 +1,106 @@
+#include "Includes/contactCache.h"
+#include <algorithm>
+
+static unsigned int hashPair(int a, int b)
+{
+  return static_cast<unsigned int>(a) * 73856093u ^ static_cast<unsigned int>(b) * 19349663u;
+}
+
+// The table is kept at least twice the number of contacts so probe chains
+// stay short.
+static size_t tableSize(size_t contactCount)
+{
+  size_t required = 16;
+  while (required < contactCount * 2)
+  {
+    required *= 2;
+  }
+  return required;
+}
+
+void ContactCache::reserve(int contactCount)
+{
+  contacts.reserve(contactCount);
+  previous.reserve(contactCount);
+  table.resize(std::max(table.size(), tableSize(contactCount)));
+}
+
+void ContactCache::beginStep()
+{
+  previous.swap(contacts);
+  contacts.clear();
+
+  size_t required = tableSize(previous.size());
+  if (table.size() < required)
+  {
+    table.resize(required);
+  }
+  std::fill(table.begin(), table.end(), -1);
+
+  unsigned int mask = static_cast<unsigned int>(table.size()) - 1;
+  for (int i = 0; i < static_cast<int>(previous.size()); i++)
+  {
+    unsigned int slot = hashPair(previous[i].a, previous[i].b) & mask;
+    while (table[slot] != -1)
+    {
+      slot = (slot + 1) & mask;
+    }
+    table[slot] = i;
+  }
+}
+
+const Contact *ContactCache::findPrevious(int a, int b) const
+{
+  if (previous.empty())
+    return nullptr;
+
+  unsigned int mask = static_cast<unsigned int>(table.size()) - 1;
+  unsigned int slot = hashPair(a, b) & mask;
+  while (table[slot] != -1)
+  {
+    const Contact &contact = previous[table[slot]];
+    if (contact.a == a && contact.b == b)
+    {
+      return &contact;
+    }
+    slot = (slot + 1) & mask;
+  }
+  return nullptr;
+}
+
+Contact &ContactCache::add(int a, int b, const Manifold &manifold)
+{
+  contacts.push_back(Contact{a, b, manifold});
+  Contact &contact = contacts.back();
+
+  const Contact *old = findPrevious(a, b);
+  if (old == nullptr)
+    return contact;
+
+  for (int i = 0; i < contact.manifold.pointCount; i++)
+  {
+    ContactPoint &point = contact.manifold.points[i];
+    for (int j = 0; j < old->manifold.pointCount; j++)
+    {
+      const ContactPoint &oldPoint = old->manifold.points[j];
+      if (oldPoint.id == point.id)
+      {
+        point.normalImpulse = oldPoint.normalImpulse;
+        point.tangentImpulse = oldPoint.tangentImpulse;
+        break;
+      }
+    }
+  }
+
+  return contact;
+}
+
+bool ContactCache::keep(int a, int b)
+{
+  const Contact *old = findPrevious(a, b);
+  if (old == nullptr)
+    return false;
+
+  contacts.push_back(*old);
+  return true;
+}
@@ -0,0 +1,434 @@
+#include "Includes/contactSolver.h"
+#include "Includes/physicsWorld.h"
+#include <cmath>
+#include <algorithm>
+
+static glm::vec2 tangentOf(glm::vec2 normal)
+{
+  return glm::vec2(normal.y, -normal.x);
+}
+
+void ContactSolver::reserve(int bodyCount)
+{
+  startPositions.reserve(bodyCount);
+  startRotations.reserve(bodyCount);
+}
+
+void ContactSolver::reset(PhysicsWorld &world, float deltaTime)
+{
+  this->world = &world;
+  inverseDeltaTime = deltaTime > 0.0f ? 1.0f / deltaTime : 0.0f;
+
+  startPositions.assign(world.positions.begin(), world.positions.end());
+  startRotations.assign(world.rotations.begin(), world.rotations.end());
+}
+
+void ContactSolver::prepare(const std::vector<Contact> &contacts, int begin, int end, ContactConstraint *constraints) const
+{
+  const PhysicsWorld &world = *this->world;
+
+  for (int i = begin; i < end; i++)
+  {
+    const Contact &contact = contacts[i];
+    ContactConstraint &constraint = constraints[i - begin];
+
+    int a = contact.a;
+    int b = contact.b;
+
+    constraint.a = a;
+    constraint.b = b;
+    constraint.normal = contact.manifold.normal;
+    constraint.friction = std::sqrt(world.frictions[a] * world.frictions[b]);
+    constraint.pointCount = contact.manifold.pointCount;
+
+    constraint.inverseMassA = world.inverseMasses[a];
+    constraint.inverseMassB = world.inverseMasses[b];
+    constraint.inverseInertiaA = world.inverseInertias[a];
+    constraint.inverseInertiaB = world.inverseInertias[b];
+
+    float restitution = std::min(world.restitutions[a], world.restitutions[b]);
+    glm::vec2 normal = constraint.normal;
+    glm::vec2 tangent = tangentOf(normal);
+
+    for (int j = 0; j < constraint.pointCount; j++)
+    {
+      const ContactPoint &point = contact.manifold.points[j];
+      ContactConstraintPoint &constraintPoint = constraint.points[j];
+
+      constraintPoint.anchorA = point.position - world.positions[a];
+      constraintPoint.anchorB = point.position - world.positions[b];
+      constraintPoint.baseSeparation = point.separation;
+      // Impulses carried over to a point that is no longer touching would
+      // push the bodies apart across the gap, so only touching points are
+      // warm started.
+      bool warm = world.warmStarting && point.separation <= 0.0f;
+      constraintPoint.normalImpulse = warm ? point.normalImpulse : 0.0f;
+      constraintPoint.tangentImpulse = warm ? point.tangentImpulse : 0.0f;
+
+      float rnA = cross(constraintPoint.anchorA, normal);
+      float rnB = cross(constraintPoint.anchorB, normal);
+      float normalMass = constraint.inverseMassA + constraint.inverseMassB + constraint.inverseInertiaA * rnA * rnA + constraint.inverseInertiaB * rnB * rnB;
+      constraintPoint.normalMass = normalMass > 0.0f ? 1.0f / normalMass : 0.0f;
+
+      float rtA = cross(constraintPoint.anchorA, tangent);
+      float rtB = cross(constraintPoint.anchorB, tangent);
+      float tangentMass = constraint.inverseMassA + constraint.inverseMassB + constraint.inverseInertiaA * rtA * rtA + constraint.inverseInertiaB * rtB * rtB;
+      constraintPoint.tangentMass = tangentMass > 0.0f ? 1.0f / tangentMass : 0.0f;
+
+      // Points bounce only off impacts fast enough to matter, so resting
+      // contacts do not jitter. A speculative point otherwise lets the bodies
+      // approach as fast as closes the gap within the step, and bounces only
+      // if they would meet before the step ends; the bounce then starts from
+      // the gap, up to one step's motion short of the surface.
+      glm::vec2 relativeVelocity = world.linearVelocities[b] + cross(world.angularVelocities[b], constraintPoint.anchorB) - world.linearVelocities[a] - cross(world.angularVelocities[a], constraintPoint.anchorA);
+      float velocityAlongNormal = glm::dot(relativeVelocity, normal);
+      float bounce = velocityAlongNormal < -world.restitutionThreshold ? -restitution * velocityAlongNormal : 0.0f;
+      float closing = -point.separation * inverseDeltaTime;
+      if (point.separation > 0.0f && (bounce == 0.0f || velocityAlongNormal > closing))
+      {
+        constraintPoint.velocityBias = closing;
+      }
+      else
+      {
+        constraintPoint.velocityBias = bounce;
+      }
+    }
+  }
+}
+
+void ContactSolver::warmStart(const ContactConstraint *constraints, int count)
+{
+  std::vector<glm::vec2> &linearVelocities = world->linearVelocities;
+  std::vector<float> &angularVelocities = world->angularVelocities;
+
+  for (int i = 0; i < count; i++)
+  {
+    const ContactConstraint &constraint = constraints[i];
+    glm::vec2 tangent = tangentOf(constraint.normal);
+
+    for (int j = 0; j < constraint.pointCount; j++)
+    {
+      const ContactConstraintPoint &point = constraint.points[j];
+      glm::vec2 impulse = point.normalImpulse * constraint.normal + point.tangentImpulse * tangent;
+
+      if (constraint.inverseMassA > 0.0f)
+      {
+        linearVelocities[constraint.a] -= constraint.inverseMassA * impulse;
+        angularVelocities[constraint.a] -= constraint.inverseInertiaA * cross(point.anchorA, impulse);
+      }
+      if (constraint.inverseMassB > 0.0f)
+      {
+        linearVelocities[constraint.b] += constraint.inverseMassB * impulse;
+        angularVelocities[constraint.b] += constraint.inverseInertiaB * cross(point.anchorB, impulse);
+      }
+    }
+  }
+}
+
+void ContactSolver::solveVelocities(ContactConstraint *constraints, int count)
+{
+  std::vector<glm::vec2> &linearVelocities = world->linearVelocities;
+  std::vector<float> &angularVelocities = world->angularVelocities;
+
+  for (int i = 0; i < count; i++)
+  {
+    ContactConstraint &constraint = constraints[i];
+    int a = constraint.a;
+    int b = constraint.b;
+    glm::vec2 normal = constraint.normal;
+    glm::vec2 tangent = tangentOf(normal);
+
+    glm::vec2 velocityA = linearVelocities[a];
+    float angularA = angularVelocities[a];
+    glm::vec2 velocityB = linearVelocities[b];
+    float angularB = angularVelocities[b];
+
+    // Friction first so the normal impulse, which matters more, has the
+    // final say within the iteration.
+    for (int j = 0; j < constraint.pointCount; j++)
+    {
+      ContactConstraintPoint &point = constraint.points[j];
+
+      glm::vec2 relativeVelocity = velocityB + cross(angularB, point.anchorB) - velocityA - cross(angularA, point.anchorA);
+      float lambda = -point.tangentMass * glm::dot(relativeVelocity, tangent);
+
+      float maxFriction = constraint.friction * point.normalImpulse;
+      float newImpulse = glm::clamp(point.tangentImpulse + lambda, -maxFriction, maxFriction);
+      lambda = newImpulse - point.tangentImpulse;
+      point.tangentImpulse = newImpulse;
+
+      glm::vec2 impulse = lambda * tangent;
+      velocityA -= constraint.inverseMassA * impulse;
+      angularA -= constraint.inverseInertiaA * cross(point.anchorA, impulse);
+      velocityB += constraint.inverseMassB * impulse;
+      angularB += constraint.inverseInertiaB * cross(point.anchorB, impulse);
+    }
+
+    for (int j = 0; j < constraint.pointCount; j++)
+    {
+      ContactConstraintPoint &point = constraint.points[j];
+
+      glm::vec2 relativeVelocity = velocityB + cross(angularB, point.anchorB) - velocityA - cross(angularA, point.anchorA);
+      float lambda = -point.normalMass * (glm::dot(relativeVelocity, normal) - point.velocityBias);
+
+      float newImpulse = std::max(point.normalImpulse + lambda, 0.0f);
+      lambda = newImpulse - point.normalImpulse;
+      point.normalImpulse = newImpulse;
+
+      glm::vec2 impulse = lambda * normal;
+      velocityA -= constraint.inverseMassA * impulse;
+      angularA -= constraint.inverseInertiaA * cross(point.anchorA, impulse);
+      velocityB += constraint.inverseMassB * impulse;
+      angularB += constraint.inverseInertiaB * cross(point.anchorB, impulse);
+    }
+
+    // Static bodies are shared between islands solved on different threads,
+    // so only dynamic bodies are written back.
+    if (constraint.inverseMassA > 0.0f)
+    {
+      linearVelocities[a] = velocityA;
+      angularVelocities[a] = angularA;
+    }
+    if (constraint.inverseMassB > 0.0f)
+    {
+      linearVelocities[b] = velocityB;
+      angularVelocities[b] = angularB;
+    }
+  }
+}
+
+float ContactSolver::currentSeparation(const ContactConstraint &constraint, const ContactConstraintPoint &point) const
+{
+  const std::vector<glm::vec2> &positions = world->positions;
+  const std::vector<float> &rotations = world->rotations;
+  int a = constraint.a;
+  int b = constraint.b;
+
+  glm::vec2 displacementA = positions[a] - startPositions[a] + cross(glm::radians(rotations[a] - startRotations[a]), point.anchorA);
+  glm::vec2 displacementB = positions[b] - startPositions[b] + cross(glm::radians(rotations[b] - startRotations[b]), point.anchorB);
+  return point.baseSeparation + glm::dot(displacementB - displacementA, constraint.normal);
+}
+
+// Pseudo impulses on positions. The current separation of each point is its
+// separation when the manifold was built plus the relative displacement of
+// its anchors since then, which covers both integration and earlier
+// corrections.
+void ContactSolver::solvePositions(const ContactConstraint *constraints, int count)
+{
+  std::vector<glm::vec2> &positions = world->positions;
+  std::vector<float> &rotations = world->rotations;
+
+  float slop = world->linearSlop;
+  float correction = world->positionCorrection;
+  float maxCorrection = world->maxLinearCorrection;
+
+  for (int i = 0; i < count; i++)
+  {
+    const ContactConstraint &constraint = constraints[i];
+    int a = constraint.a;
+    int b = constraint.b;
+    glm::vec2 normal = constraint.normal;
+
+    for (int j = 0; j < constraint.pointCount; j++)
+    {
+      const ContactConstraintPoint &point = constraint.points[j];
+      float separation = currentSeparation(constraint, point);
+
+      float C = glm::clamp(correction * (separation + slop), -maxCorrection, 0.0f);
+      glm::vec2 impulse = (-point.normalMass * C) * normal;
+
+      if (constraint.inverseMassA > 0.0f)
+      {
+        positions[a] -= constraint.inverseMassA * impulse;
+        rotations[a] -= glm::degrees(constraint.inverseInertiaA * cross(point.anchorA, impulse));
+      }
+      if (constraint.inverseMassB > 0.0f)
+      {
+        positions[b] += constraint.inverseMassB * impulse;
+        rotations[b] += glm::degrees(constraint.inverseInertiaB * cross(point.anchorB, impulse));
+      }
+    }
+  }
+}
+
+void ContactSolver::storeImpulses(const ContactConstraint *constraints, std::vector<Contact> &contacts, int begin, int end) const
+{
+  for (int i = begin; i < end; i++)
+  {
+    Manifold &manifold = contacts[i].manifold;
+    const ContactConstraint &constraint = constraints[i - begin];
+    for (int j = 0; j < manifold.pointCount; j++)
+    {
+      manifold.points[j].normalImpulse = constraint.points[j].normalImpulse;
+      manifold.points[j].tangentImpulse = constraint.points[j].tangentImpulse;
+    }
+  }
+}
+
+static Softness makeSoftness(float hertz, float dampingRatio, float subStep)
+{
+  float omega = 2.0f * 3.14159265f * hertz;
+  float a1 = 2.0f * dampingRatio + subStep * omega;
+  float a2 = subStep * omega * a1;
+  float a3 = 1.0f / (1.0f + a2);
+  return Softness{omega / a1, a2 * a3, a3};
+}
+
+// A spring stiffer than a quarter of the substep rate can not be resolved by
+// the substeps, so the stiffness is capped there. Contacts against static
+// bodies carry the weight of everything above them and get twice the
+// stiffness.
+void ContactSolver::setSoftness(float subStep, float contactHertz, float dampingRatio, float maxBiasVelocity)
+{
+  float hertz = std::min(contactHertz, 0.25f / subStep);
+
+  inverseSubStep = 1.0f / subStep;
+  contactSoftness = makeSoftness(hertz, dampingRatio, subStep);
+  staticSoftness = makeSoftness(2.0f * hertz, dampingRatio, subStep);
+  this->maxBiasVelocity = maxBiasVelocity;
+}
+
+// One pass of the soft step. With useBias the contact pushes apart
+// penetrating bodies as a spring would, capped at maxBiasVelocity; without
+// it the pass only removes the velocity the spring added. Points that have
+// separated since the manifold was built let the bodies close the gap
+// within the substep but no faster.
+void ContactSolver::solveSoft(ContactConstraint *constraints, int count, bool useBias)
+{
+  std::vector<glm::vec2> &linearVelocities = world->linearVelocities;
+  std::vector<float> &angularVelocities = world->angularVelocities;
+
+  for (int i = 0; i < count; i++)
+  {
+    ContactConstraint &constraint = constraints[i];
+    int a = constraint.a;
+    int b = constraint.b;
+    glm::vec2 normal = constraint.normal;
+    glm::vec2 tangent = tangentOf(normal);
+
+    bool touchesStatic = constraint.inverseMassA == 0.0f || constraint.inverseMassB == 0.0f;
+    const Softness &softness = touchesStatic ? staticSoftness : contactSoftness;
+
+    glm::vec2 velocityA = linearVelocities[a];
+    float angularA = angularVelocities[a];
+    glm::vec2 velocityB = linearVelocities[b];
+    float angularB = angularVelocities[b];
+
+    for (int j = 0; j < constraint.pointCount; j++)
+    {
+      ContactConstraintPoint &point = constraint.points[j];
+      float separation = currentSeparation(constraint, point);
+
+      float bias = 0.0f;
+      float massScale = 1.0f;
+      float impulseScale = 0.0f;
+      if (separation > 0.0f)
+      {
+        bias = separation * inverseSubStep;
+      }
+      else if (useBias)
+      {
+        bias = std::max(softness.biasRate * separation, -maxBiasVelocity);
+        massScale = softness.massScale;
+        impulseScale = softness.impulseScale;
+      }
+
+      glm::vec2 relativeVelocity = velocityB + cross(angularB, point.anchorB) - velocityA - cross(angularA, point.anchorA);
+      float velocityAlongNormal = glm::dot(relativeVelocity, normal);
+      float lambda = -point.normalMass * massScale * (velocityAlongNormal + bias) - impulseScale * point.normalImpulse;
+
+      float newImpulse = std::max(point.normalImpulse + lambda, 0.0f);
+      lambda = newImpulse - point.normalImpulse;
+      point.normalImpulse = newImpulse;
+
+      glm::vec2 impulse = lambda * normal;
+      velocityA -= constraint.inverseMassA * impulse;
+      angularA -= constraint.inverseInertiaA * cross(point.anchorA, impulse);
+      velocityB += constraint.inverseMassB * impulse;
+      angularB += constraint.inverseInertiaB * cross(point.anchorB, impulse);
+    }
+
+    for (int j = 0; j < constraint.pointCount; j++)
+    {
+      ContactConstraintPoint &point = constraint.points[j];
+
+      glm::vec2 relativeVelocity = velocityB + cross(angularB, point.anchorB) - velocityA - cross(angularA, point.anchorA);
+      float lambda = -point.tangentMass * glm::dot(relativeVelocity, tangent);
+
+      float maxFriction = constraint.friction * point.normalImpulse;
+      float newImpulse = glm::clamp(point.tangentImpulse + lambda, -maxFriction, maxFriction);
+      lambda = newImpulse - point.tangentImpulse;
+      point.tangentImpulse = newImpulse;
+
+      glm::vec2 impulse = lambda * tangent;
+      velocityA -= constraint.inverseMassA * impulse;
+      angularA -= constraint.inverseInertiaA * cross(point.anchorA, impulse);
+      velocityB += constraint.inverseMassB * impulse;
+      angularB += constraint.inverseInertiaB * cross(point.anchorB, impulse);
+    }
+
+    if (constraint.inverseMassA > 0.0f)
+    {
+      linearVelocities[a] = velocityA;
+      angularVelocities[a] = angularA;
+    }
+    if (constraint.inverseMassB > 0.0f)
+    {
+      linearVelocities[b] = velocityB;
+      angularVelocities[b] = angularB;
+    }
+  }
+}
+
+// Restores the bounce of fast impacts, which the soft passes damp out. The
+// target velocity was recorded by prepare from the velocities before the
+// step.
+void ContactSolver::applyRestitution(ContactConstraint *constraints, int count)
+{
+  std::vector<glm::vec2> &linearVelocities = world->linearVelocities;
+  std::vector<float> &angularVelocities = world->angularVelocities;
+
+  for (int i = 0; i < count; i++)
+  {
+    ContactConstraint &constraint = constraints[i];
+    int a = constraint.a;
+    int b = constraint.b;
+    glm::vec2 normal = constraint.normal;
+
+    glm::vec2 velocityA = linearVelocities[a];
+    float angularA = angularVelocities[a];
+    glm::vec2 velocityB = linearVelocities[b];
+    float angularB = angularVelocities[b];
+
+    for (int j = 0; j < constraint.pointCount; j++)
+    {
+      ContactConstraintPoint &point = constraint.points[j];
+      if (point.velocityBias <= 0.0f)
+        continue;
+
+      glm::vec2 relativeVelocity = velocityB + cross(angularB, point.anchorB) - velocityA - cross(angularA, point.anchorA);
+      float lambda = -point.normalMass * (glm::dot(relativeVelocity, normal) - point.velocityBias);
+
+      float newImpulse = std::max(point.normalImpulse + lambda, 0.0f);
+      lambda = newImpulse - point.normalImpulse;
+      point.normalImpulse = newImpulse;
+
+      glm::vec2 impulse = lambda * normal;
+      velocityA -= constraint.inverseMassA * impulse;
+      angularA -= constraint.inverseInertiaA * cross(point.anchorA, impulse);
+      velocityB += constraint.inverseMassB * impulse;
+      angularB += constraint.inverseInertiaB * cross(point.anchorB, impulse);
+    }
+
+    if (constraint.inverseMassA > 0.0f)
+    {
+      linearVelocities[a] = velocityA;
+      angularVelocities[a] = angularA;
+    }
+    if (constraint.inverseMassB > 0.0f)
+    {
+      linearVelocities[b] = velocityB;
+      angularVelocities[b] = angularB;
+    }
+  }
+}
@@ -0,0 +1,439 @@
+#include "Includes/dynamicTree.h"
+#include <algorithm>
+
+DynamicTree::DynamicTree(float margin) : margin(margin)
+{
+}
+
+bool DynamicTree::isLeaf(int node) const
+{
+  return nodes[node].child1 == -1;
+}
+
+int DynamicTree::allocateNode()
+{
+  int node;
+  if (freeList == -1)
+  {
+    node = static_cast<int>(nodes.size());
+    nodes.push_back(TreeNode());
+  }
+  else
+  {
+    node = freeList;
+    freeList = nodes[node].parent;
+  }
+
+  nodes[node].parent = -1;
+  nodes[node].child1 = -1;
+  nodes[node].child2 = -1;
+  nodes[node].height = 0;
+  nodes[node].body = -1;
+  return node;
+}
+
+// Free nodes are chained through their parent index.
+void DynamicTree::freeNode(int node)
+{
+  nodes[node].parent = freeList;
+  nodes[node].height = -1;
+  freeList = node;
+}
+
+int DynamicTree::createProxy(const AABB &box, int body)
+{
+  int proxy = allocateNode();
+  nodes[proxy].box = AABB{box.min - glm::vec2(margin), box.max + glm::vec2(margin)};
+  nodes[proxy].body = body;
+  insertLeaf(proxy);
+  return proxy;
+}
+
+void DynamicTree::destroyProxy(int proxy)
+{
+  removeLeaf(proxy);
+  freeNode(proxy);
+}
+
+// Returns true when the body left its fat bounds and the leaf was reinserted.
+bool DynamicTree::moveProxy(int proxy, const AABB &box)
+{
+  if (aabbContains(nodes[proxy].box, box))
+    return false;
+
+  removeLeaf(proxy);
+  nodes[proxy].box = AABB{box.min - glm::vec2(margin), box.max + glm::vec2(margin)};
+  insertLeaf(proxy);
+  return true;
+}
+
+const AABB &DynamicTree::getFatAABB(int proxy) const
+{
+  return nodes[proxy].box;
+}
+
+int DynamicTree::getHeight() const
+{
+  return root == -1 ? 0 : nodes[root].height;
+}
+
+// Walks down picking the child that grows the least in perimeter, then pairs
+// the new leaf with the sibling found there.
+void DynamicTree::insertLeaf(int leaf)
+{
+  if (root == -1)
+  {
+    root = leaf;
+    nodes[root].parent = -1;
+    return;
+  }
+
+  AABB leafBox = nodes[leaf].box;
+  int index = root;
+  while (!isLeaf(index))
+  {
+    int child1 = nodes[index].child1;
+    int child2 = nodes[index].child2;
+
+    float area = aabbPerimeter(nodes[index].box);
+    float combinedArea = aabbPerimeter(aabbUnion(nodes[index].box, leafBox));
+
+    float cost = 2.0f * combinedArea;
+    float inheritanceCost = 2.0f * (combinedArea - area);
+
+    float cost1 = aabbPerimeter(aabbUnion(leafBox, nodes[child1].box)) + inheritanceCost;
+    if (!isLeaf(child1))
+    {
+      cost1 -= aabbPerimeter(nodes[child1].box);
+    }
+
+    float cost2 = aabbPerimeter(aabbUnion(leafBox, nodes[child2].box)) + inheritanceCost;
+    if (!isLeaf(child2))
+    {
+      cost2 -= aabbPerimeter(nodes[child2].box);
+    }
+
+    if (cost < cost1 && cost < cost2)
+      break;
+
+    index = cost1 < cost2 ? child1 : child2;
+  }
+
+  int sibling = index;
+  int oldParent = nodes[sibling].parent;
+  int newParent = allocateNode();
+  nodes[newParent].parent = oldParent;
+  nodes[newParent].box = aabbUnion(leafBox, nodes[sibling].box);
+  nodes[newParent].height = nodes[sibling].height + 1;
+  nodes[newParent].child1 = sibling;
+  nodes[newParent].child2 = leaf;
+  nodes[sibling].parent = newParent;
+  nodes[leaf].parent = newParent;
+
+  if (oldParent == -1)
+  {
+    root = newParent;
+  }
+  else if (nodes[oldParent].child1 == sibling)
+  {
+    nodes[oldParent].child1 = newParent;
+  }
+  else
+  {
+    nodes[oldParent].child2 = newParent;
+  }
+
+  refit(nodes[leaf].parent);
+}
+
+void DynamicTree::removeLeaf(int leaf)
+{
+  if (leaf == root)
+  {
+    root = -1;
+    return;
+  }
+
+  int parent = nodes[leaf].parent;
+  int grandParent = nodes[parent].parent;
+  int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+  freeNode(parent);
+
+  if (grandParent == -1)
+  {
+    root = sibling;
+    nodes[sibling].parent = -1;
+    return;
+  }
+
+  if (nodes[grandParent].child1 == parent)
+  {
+    nodes[grandParent].child1 = sibling;
+  }
+  else
+  {
+    nodes[grandParent].child2 = sibling;
+  }
+  nodes[sibling].parent = grandParent;
+
+  refit(grandParent);
+}
+
+// Recomputes bounds and heights from node up to the root, rebalancing each
+// ancestor on the way.
+void DynamicTree::refit(int node)
+{
+  int index = node;
+  while (index != -1)
+  {
+    index = balance(index);
+
+    int child1 = nodes[index].child1;
+    int child2 = nodes[index].child2;
+    nodes[index].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+    nodes[index].box = aabbUnion(nodes[child1].box, nodes[child2].box);
+
+    index = nodes[index].parent;
+  }
+}
+
+// Rotates the taller grandchild up when the two subtrees of a differ in
+// height by more than one. Returns the node now at a's position.
+int DynamicTree::balance(int a)
+{
+  if (isLeaf(a) || nodes[a].height < 2)
+    return a;
+
+  int b = nodes[a].child1;
+  int c = nodes[a].child2;
+  int heightDifference = nodes[c].height - nodes[b].height;
+
+  if (heightDifference > 1)
+  {
+    int f = nodes[c].child1;
+    int g = nodes[c].child2;
+
+    nodes[c].child1 = a;
+    nodes[c].parent = nodes[a].parent;
+    nodes[a].parent = c;
+
+    int parent = nodes[c].parent;
+    if (parent == -1)
+    {
+      root = c;
+    }
+    else if (nodes[parent].child1 == a)
+    {
+      nodes[parent].child1 = c;
+    }
+    else
+    {
+      nodes[parent].child2 = c;
+    }
+
+    if (nodes[f].height > nodes[g].height)
+    {
+      nodes[c].child2 = f;
+      nodes[a].child2 = g;
+      nodes[g].parent = a;
+      nodes[a].box = aabbUnion(nodes[b].box, nodes[g].box);
+      nodes[c].box = aabbUnion(nodes[a].box, nodes[f].box);
+      nodes[a].height = 1 + std::max(nodes[b].height, nodes[g].height);
+      nodes[c].height = 1 + std::max(nodes[a].height, nodes[f].height);
+    }
+    else
+    {
+      nodes[c].child2 = g;
+      nodes[a].child2 = f;
+      nodes[f].parent = a;
+      nodes[a].box = aabbUnion(nodes[b].box, nodes[f].box);
+      nodes[c].box = aabbUnion(nodes[a].box, nodes[g].box);
+      nodes[a].height = 1 + std::max(nodes[b].height, nodes[f].height);
+      nodes[c].height = 1 + std::max(nodes[a].height, nodes[g].height);
+    }
+    return c;
+  }
+
+  if (heightDifference < -1)
+  {
+    int d = nodes[b].child1;
+    int e = nodes[b].child2;
+
+    nodes[b].child1 = a;
+    nodes[b].parent = nodes[a].parent;
+    nodes[a].parent = b;
+
+    int parent = nodes[b].parent;
+    if (parent == -1)
+    {
+      root = b;
+    }
+    else if (nodes[parent].child1 == a)
+    {
+      nodes[parent].child1 = b;
+    }
+    else
+    {
+      nodes[parent].child2 = b;
+    }
+
+    if (nodes[d].height > nodes[e].height)
+    {
+      nodes[b].child2 = d;
+      nodes[a].child1 = e;
+      nodes[e].parent = a;
+      nodes[a].box = aabbUnion(nodes[c].box, nodes[e].box);
+      nodes[b].box = aabbUnion(nodes[a].box, nodes[d].box);
+      nodes[a].height = 1 + std::max(nodes[c].height, nodes[e].height);
+      nodes[b].height = 1 + std::max(nodes[a].height, nodes[d].height);
+    }
+    else
+    {
+      nodes[b].child2 = e;
+      nodes[a].child1 = d;
+      nodes[d].parent = a;
+      nodes[a].box = aabbUnion(nodes[c].box, nodes[d].box);
+      nodes[b].box = aabbUnion(nodes[a].box, nodes[e].box);
+      nodes[a].height = 1 + std::max(nodes[c].height, nodes[d].height);
+      nodes[b].height = 1 + std::max(nodes[a].height, nodes[e].height);
+    }
+    return b;
+  }
+
+  return a;
+}
+
+// Leaves of destroyed bodies are removed; the rest only change the body they
+// point at. Bodies that moved into a freed id get a leaf in findPairs.
+void DynamicTree::remapBodies(const std::vector<int> &newIndices, int bodyCount)
+{
+  std::vector<int> &remapped = remappedProxies;
+  remapped.assign(bodyCount, -1);
+  for (int i = 0; i < static_cast<int>(proxies.size()); i++)
+  {
+    if (proxies[i] == -1)
+      continue;
+
+    int body = newIndices[i];
+    if (body < 0)
+    {
+      destroyProxy(proxies[i]);
+      continue;
+    }
+
+    remapped[body] = proxies[i];
+    nodes[proxies[i]].body = body;
+  }
+  proxies.swap(remapped);
+}
+
+// A tree over n leaves has 2n - 1 nodes.
+void DynamicTree::reserve(int bodyCount)
+{
+  nodes.reserve(2 * bodyCount);
+  proxies.reserve(bodyCount);
+  remappedProxies.reserve(bodyCount);
+  pairStack.reserve(bodyCount);
+}
+
+void DynamicTree::findPairs(const std::vector<AABB> &bounds, std::vector<BodyPair> &pairs)
+{
+  pairs.clear();
+
+  int count = static_cast<int>(bounds.size());
+  proxies.resize(count, -1);
+  for (int i = 0; i < count; i++)
+  {
+    if (proxies[i] == -1)
+    {
+      proxies[i] = createProxy(bounds[i], i);
+    }
+    else
+    {
+      moveProxy(proxies[i], bounds[i]);
+    }
+  }
+
+  if (root == -1)
+    return;
+
+  // Self traversal: a node paired with itself expands into its two children
+  // paired with themselves and with each other, so every leaf pair is visited
+  // exactly once.
+  pairStack.clear();
+  pairStack.push_back({root, root});
+  while (!pairStack.empty())
+  {
+    NodePair pair = pairStack.back();
+    pairStack.pop_back();
+
+    const TreeNode &nodeA = nodes[pair.a];
+    const TreeNode &nodeB = nodes[pair.b];
+
+    if (pair.a == pair.b)
+    {
+      if (isLeaf(pair.a))
+        continue;
+
+      pairStack.push_back({nodeA.child1, nodeA.child1});
+      pairStack.push_back({nodeA.child2, nodeA.child2});
+      pairStack.push_back({nodeA.child1, nodeA.child2});
+      continue;
+    }
+
+    if (!aabbOverlap(nodeA.box, nodeB.box))
+      continue;
+
+    bool leafA = isLeaf(pair.a);
+    bool leafB = isLeaf(pair.b);
+
+    if (leafA && leafB)
+    {
+      if (aabbOverlap(bounds[nodeA.body], bounds[nodeB.body]))
+      {
+        pairs.push_back({std::min(nodeA.body, nodeB.body), std::max(nodeA.body, nodeB.body)});
+      }
+    }
+    else if (leafB || (!leafA && aabbPerimeter(nodeA.box) >= aabbPerimeter(nodeB.box)))
+    {
+      pairStack.push_back({nodeA.child1, pair.b});
+      pairStack.push_back({nodeA.child2, pair.b});
+    }
+    else
+    {
+      pairStack.push_back({pair.a, nodeB.child1});
+      pairStack.push_back({pair.a, nodeB.child2});
+    }
+  }
+}
+
+void DynamicTree::query(const AABB &box, const std::vector<AABB> &bounds, std::vector<int> &bodies) const
+{
+  if (root == -1)
+    return;
+
+  queryStack.clear();
+  queryStack.push_back(root);
+  while (!queryStack.empty())
+  {
+    int index = queryStack.back();
+    queryStack.pop_back();
+
+    const TreeNode &node = nodes[index];
+    if (!aabbOverlap(node.box, box))
+      continue;
+
+    if (isLeaf(index))
+    {
+      if (node.body < static_cast<int>(bounds.size()) && aabbOverlap(bounds[node.body], box))
+      {
+        bodies.push_back(node.body);
+      }
+      continue;
+    }
+
+    queryStack.push_back(node.child1);
+    queryStack.push_back(node.child2);
+  }
+}
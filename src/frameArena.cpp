@@ -0,0 +1,61 @@
+#include "Includes/frameArena.h"
+
+static size_t blockWords(size_t bytes)
+{
+  return (bytes + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t);
+}
+
+FrameArena::FrameArena(size_t capacity)
+{
+  blockSize = blockWords(capacity) * sizeof(std::max_align_t);
+  block.reset(new std::max_align_t[blockWords(capacity)]);
+}
+
+void *FrameArena::allocateBytes(size_t bytes, size_t alignment)
+{
+  size_t start = (offset + alignment - 1) & ~(alignment - 1);
+  if (start + bytes <= blockSize)
+  {
+    offset = start + bytes;
+    return reinterpret_cast<unsigned char *>(block.get()) + start;
+  }
+
+  // Overflow blocks are sized to the request alone; reset folds them into
+  // the main block.
+  overflow.emplace_back(new std::max_align_t[blockWords(bytes == 0 ? 1 : bytes)]);
+  overflowUsed += blockWords(bytes == 0 ? 1 : bytes) * sizeof(std::max_align_t);
+  return overflow.back().get();
+}
+
+void FrameArena::reset()
+{
+  if (!overflow.empty())
+  {
+    size_t required = offset + overflowUsed;
+    overflow.clear();
+    overflowUsed = 0;
+
+    blockSize = blockWords(required + required / 2) * sizeof(std::max_align_t);
+    block.reset(new std::max_align_t[blockSize / sizeof(std::max_align_t)]);
+  }
+  offset = 0;
+}
+
+void FrameArena::reserve(size_t capacity)
+{
+  if (capacity <= blockSize)
+    return;
+
+  blockSize = blockWords(capacity) * sizeof(std::max_align_t);
+  block.reset(new std::max_align_t[blockSize / sizeof(std::max_align_t)]);
+}
+
+size_t FrameArena::used() const
+{
+  return offset + overflowUsed;
+}
+
+size_t FrameArena::capacity() const
+{
+  return blockSize;
+}
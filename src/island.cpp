@@ -0,0 +1,159 @@
+#include "Includes/island.h"
+
+int IslandBuilder::findRoot(int body)
+{
+  while (parent[body] != body)
+  {
+    parent[body] = parent[parent[body]];
+    body = parent[body];
+  }
+  return body;
+}
+
+void IslandBuilder::merge(int a, int b)
+{
+  int rootA = findRoot(a);
+  int rootB = findRoot(b);
+  if (rootA != rootB)
+  {
+    parent[rootB] = rootA;
+  }
+}
+
+// Every body is in at most one island, so the island lists never need more
+// than one entry per body.
+void IslandBuilder::reserve(int bodyCount, int contactCount)
+{
+  islands.reserve(bodyCount);
+  bodies.reserve(bodyCount);
+  parent.reserve(bodyCount);
+  islandOf.reserve(bodyCount);
+  order.reserve(bodyCount);
+  unordered.reserve(bodyCount);
+  contactIslands.reserve(contactCount);
+  sorted.reserve(contactCount);
+}
+
+void IslandBuilder::build(const std::vector<unsigned char> &staticFlags, const std::vector<unsigned char> &awakeFlags, std::vector<Contact> &contacts)
+{
+  int bodyCount = static_cast<int>(staticFlags.size());
+  int contactCount = static_cast<int>(contacts.size());
+
+  parent.resize(bodyCount);
+  for (int i = 0; i < bodyCount; i++)
+  {
+    parent[i] = i;
+  }
+
+  for (int i = 0; i < contactCount; i++)
+  {
+    if (!staticFlags[contacts[i].a] && !staticFlags[contacts[i].b])
+    {
+      merge(contacts[i].a, contacts[i].b);
+    }
+  }
+
+  // Number the islands in the order their roots are first seen, counting
+  // bodies and noting whether anything in the island is awake.
+  islands.clear();
+  islandOf.assign(bodyCount, -1);
+  for (int i = 0; i < bodyCount; i++)
+  {
+    if (staticFlags[i])
+      continue;
+
+    int root = findRoot(i);
+    if (islandOf[root] == -1)
+    {
+      islandOf[root] = static_cast<int>(islands.size());
+      islands.push_back(Island{0, 0, 0, 0, false});
+    }
+
+    islandOf[i] = islandOf[root];
+    Island &island = islands[islandOf[i]];
+    island.bodyCount++;
+    island.awake = island.awake || awakeFlags[i];
+  }
+
+  // Awake islands first, so the solver can take them as a single prefix.
+  int islandCount = static_cast<int>(islands.size());
+  order.resize(islandCount);
+  awakeIslandCount = 0;
+  for (int i = 0; i < islandCount; i++)
+  {
+    if (islands[i].awake)
+    {
+      order[i] = awakeIslandCount++;
+    }
+  }
+  int nextSleeping = awakeIslandCount;
+  for (int i = 0; i < islandCount; i++)
+  {
+    if (!islands[i].awake)
+    {
+      order[i] = nextSleeping++;
+    }
+  }
+
+  unordered.assign(islands.begin(), islands.end());
+  for (int i = 0; i < islandCount; i++)
+  {
+    islands[order[i]] = unordered[i];
+  }
+
+  for (int i = 0; i < bodyCount; i++)
+  {
+    if (!staticFlags[i])
+    {
+      islandOf[i] = order[islandOf[i]];
+    }
+  }
+
+  // Counting sort of bodies and contacts by island.
+  int bodyOffset = 0;
+  for (int i = 0; i < islandCount; i++)
+  {
+    islands[i].bodyBegin = bodyOffset;
+    bodyOffset += islands[i].bodyCount;
+    islands[i].bodyCount = 0;
+  }
+
+  bodies.resize(bodyOffset);
+  for (int i = 0; i < bodyCount; i++)
+  {
+    if (staticFlags[i])
+      continue;
+
+    Island &island = islands[islandOf[i]];
+    bodies[island.bodyBegin + island.bodyCount++] = i;
+  }
+
+  contactIslands.resize(contactCount);
+  for (int i = 0; i < contactCount; i++)
+  {
+    int body = staticFlags[contacts[i].a] ? contacts[i].b : contacts[i].a;
+    contactIslands[i] = islandOf[body];
+    islands[contactIslands[i]].contactCount++;
+  }
+
+  int contactOffset = 0;
+  awakeContactCount = 0;
+  for (int i = 0; i < islandCount; i++)
+  {
+    islands[i].contactBegin = contactOffset;
+    contactOffset += islands[i].contactCount;
+    if (i < awakeIslandCount)
+    {
+      awakeContactCount += islands[i].contactCount;
+    }
+    islands[i].contactCount = 0;
+  }
+
+  sorted.resize(contactCount);
+  for (int i = 0; i < contactCount; i++)
+  {
+    Island &island = islands[contactIslands[i]];
+    sorted[island.contactBegin + island.contactCount++] = contacts[i];
+  }
+  contacts.swap(sorted);
+}
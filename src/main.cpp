@@ -4,32 +4,40 @@
 #include <glm/glm/gtc/matrix_transform.hpp>
 #include "Includes/shader.h"
 #include "Includes/renderer.h"
-#include "Includes/rigidBody.h"
+#include "Includes/physicsWorld.h"
+#include "Includes/trace.h"
 
 void processInput(GLFWwindow *window);
 
 bool darkMode = true;
 
+// Pressing T records this many frames and writes them to trace.json.
+const int TRACE_FRAMES = 120;
+int traceFramesLeft = 0;
+
 Renderer renderer("Physics Library");
-RigidBody square(glm::vec2(500.0f, 500.0f), 0.0f, 100.0f, 100.0f, 1.0f);
+PhysicsWorld world;
+
+int square = world.addBody(glm::vec2(500.0f, 500.0f), 0.0f, 100.0f, 100.0f, 1.0f);
 
-RigidBody square2(glm::vec2(700.0f, 500.0f), 0.0f, 100.0f, 100.0f, 1.0f);
+int square2 = world.addBody(glm::vec2(700.0f, 500.0f), 0.0f, 100.0f, 100.0f, 1.0f);
 
-RigidBody square3(glm::vec2(400.0f, 200.0f), 0.0f, 1000.0f, 100.0f, 1.0f);
+int square3 = world.addBody(glm::vec2(400.0f, 200.0f), 0.0f, 1000.0f, 100.0f, 1.0f);
+
+int ball = world.addCircle(glm::vec2(600.0f, 800.0f), 50.0f, 1.0f);
 
 int main()
 {
-	// square.GRAVITY = glm::vec2(0.0f, 0.0f);
-	// square2.GRAVITY = glm::vec2(0.0f, 0.0f);
-	// square3.GRAVITY = glm::vec2(0.0f, 0.0f);
-	square3.isStatic = true;
+	// world.gravity = glm::vec2(0.0f, 0.0f);
+	world.setStatic(square3, true);
 
 	float deltaTime;
-	clock_t oldTime = clock();
+	double oldTime = glfwGetTime();
 	while (renderer.rendering())
 	{
-		clock_t currentTime = clock();
-		deltaTime = static_cast<double>(currentTime - oldTime) / CLOCKS_PER_SEC;
+		TRACE_SCOPE("frame");
+		double currentTime = glfwGetTime();
+		deltaTime = static_cast<float>(currentTime - oldTime);
 		float fps = 1 / deltaTime;
 		if (abs(deltaTime) < 0.00001)
 		{
@@ -37,12 +45,10 @@ int main()
 		}
 		oldTime = currentTime;
 
-		square.update(deltaTime);
-		square2.update(deltaTime);
-		square3.update(deltaTime);
-
 		processInput(renderer.window);
 
+		world.advance(deltaTime);
+
 		if (darkMode)
 		{
 			renderer.displayBackground(5, 5, 5, 1);
@@ -52,19 +58,25 @@ int main()
 			renderer.displayBackground(250, 250, 250, 1);
 		}
 
-		renderer.drawSquare(square.position, glm::vec2(square.width, square.height), square.rotation, glm::vec4(0.5f, 0.5f, 0.5f, 1.0f));
-
-		renderer.drawSquare(square2.position, glm::vec2(square2.width, square2.height), square2.rotation, glm::vec4(0.5f, 0.5f, 0.5f, 1.0f));
-
-		renderer.drawSquare(square3.position, glm::vec2(square3.width, square3.height), square3.rotation, glm::vec4(0.5f, 0.5f, 0.5f, 1.0f));
-
-		square.resolveCollision(&square2);
-		square.resolveCollision(&square3);
-		square2.resolveCollision(&square3);
+		for (int i = 0; i < world.bodyCount(); i++)
+		{
+			if (world.shapes[i] == ShapeType::Circle)
+				renderer.drawCircle(world.interpolatedPosition(i), glm::vec2(world.widths[i], world.heights[i]), world.interpolatedRotation(i), glm::vec4(0.5f, 0.5f, 0.5f, 1.0f));
+			else
+				renderer.drawSquare(world.interpolatedPosition(i), glm::vec2(world.widths[i], world.heights[i]), world.interpolatedRotation(i), glm::vec4(0.5f, 0.5f, 0.5f, 1.0f));
+		}
 
 		renderer.renderText("FPS: " + std::to_string(fps), 1000, 1000, 1, glm::vec3(1.0f));
+		const StepProfile &profile = world.profile();
+		renderer.renderText("Step: " + std::to_string(profile.total) + " ms, contacts: " + std::to_string(profile.contacts), 1000, 950, 1, glm::vec3(1.0f));
 
 		renderer.displayFrame();
+
+		if (traceFramesLeft > 0 && --traceFramesLeft == 0)
+		{
+			traceStop();
+			traceWrite("trace.json");
+		}
 	}
 
 	renderer.close();
@@ -75,16 +87,21 @@ void processInput(GLFWwindow *window)
 {
 	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
 		glfwSetWindowShouldClose(window, true);
+	if (glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS && traceFramesLeft == 0)
+	{
+		traceStart();
+		traceFramesLeft = TRACE_FRAMES;
+	}
 	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
-		square.applyForce(glm::vec2(50, 0), glm::vec2(square.position.x, square.position.y));
+		world.applyForce(square, glm::vec2(50, 0), glm::vec2(world.positions[square].x, world.positions[square].y));
 	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
-		square.applyForce(glm::vec2(-50, 0), glm::vec2(square.position.x, square.position.y));
+		world.applyForce(square, glm::vec2(-50, 0), glm::vec2(world.positions[square].x, world.positions[square].y));
 	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
-		square.applyForce(glm::vec2(0, 50), glm::vec2(square.position.x, square.position.y));
+		world.applyForce(square, glm::vec2(0, 50), glm::vec2(world.positions[square].x, world.positions[square].y));
 	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
-		square.applyForce(glm::vec2(0, -50), glm::vec2(square.position.x, square.position.y));
+		world.applyForce(square, glm::vec2(0, -50), glm::vec2(world.positions[square].x, world.positions[square].y));
 	if (glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS)
-		square.applyForce(glm::vec2(1, 0), glm::vec2(square.position.x, square.position.y - 1));
+		world.applyTorque(square, world.inertias[square]);
 	if (glfwGetKey(window, GLFW_KEY_G) == GLFW_PRESS)
-		square.applyForce(glm::vec2(1, 0), glm::vec2(square.position.x, square.position.y + 1));
+		world.applyTorque(square, -world.inertias[square]);
 }
\ No newline at end of file
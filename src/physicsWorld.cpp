@@ -0,0 +1,1021 @@
+#include "Includes/physicsWorld.h"
+#include "Includes/sweepAndPrune.h"
+#include "Includes/collision.h"
+#include "Includes/trace.h"
+#include <cmath>
+#include <algorithm>
+#include <cfloat>
+
+PhysicsWorld::PhysicsWorld() : broadphase(std::make_unique<SweepAndPrune>()), threadPool(std::make_unique<ThreadPool>())
+{
+}
+
+void PhysicsWorld::setWorkerCount(int count)
+{
+  threadPool = std::make_unique<ThreadPool>(count);
+  reservedBodyCount = 0;
+}
+
+int PhysicsWorld::workerCount() const
+{
+  return threadPool->workerCount();
+}
+
+int PhysicsWorld::addBody(glm::vec2 position, float rotation, float width, float height, float mass)
+{
+  positions.push_back(position);
+  rotations.push_back(rotation);
+  linearVelocities.push_back(glm::vec2(0.0f, 0.0f));
+  angularVelocities.push_back(0.0f);
+  forces.push_back(glm::vec2(0.0f, 0.0f));
+  torques.push_back(0.0f);
+
+  shapes.push_back(ShapeType::Box);
+  widths.push_back(width);
+  heights.push_back(height);
+  masses.push_back(mass);
+  inverseMasses.push_back(0.0f);
+  inertias.push_back(0.0f);
+  inverseInertias.push_back(0.0f);
+  restitutions.push_back(0.5f);
+  frictions.push_back(0.6f);
+  staticFlags.push_back(0);
+  awakeFlags.push_back(1);
+  sleepTimes.push_back(0.0f);
+  bulletFlags.push_back(0);
+  previousPositions.push_back(position);
+  previousRotations.push_back(rotation);
+
+  int body = static_cast<int>(positions.size()) - 1;
+  updateMassData(body);
+
+  int slot;
+  if (freeSlots.empty())
+  {
+    slot = static_cast<int>(slotBodies.size());
+    slotBodies.push_back(body);
+    slotGenerations.push_back(0);
+  }
+  else
+  {
+    slot = freeSlots.back();
+    freeSlots.pop_back();
+    slotBodies[slot] = body;
+  }
+  bodySlots.push_back(slot);
+
+  return body;
+}
+
+BodyHandle PhysicsWorld::createBody(glm::vec2 position, float rotation, float width, float height, float mass)
+{
+  return bodyHandle(addBody(position, rotation, width, height, mass));
+}
+
+int PhysicsWorld::addCircle(glm::vec2 position, float radius, float mass)
+{
+  int body = addBody(position, 0.0f, 2.0f * radius, 2.0f * radius, mass);
+  shapes[body] = ShapeType::Circle;
+  updateMassData(body);
+  return body;
+}
+
+BodyHandle PhysicsWorld::createCircle(glm::vec2 position, float radius, float mass)
+{
+  return bodyHandle(addCircle(position, radius, mass));
+}
+
+// Moves element last into index and drops the tail. Caches that do not yet
+// cover last are only shortened; the body moved into index is new and awake,
+// so its entry is recomputed on the next step.
+template <typename T>
+static void swapRemove(std::vector<T> &values, int index, int last)
+{
+  int size = static_cast<int>(values.size());
+  if (last < size)
+  {
+    values[index] = values[last];
+  }
+  values.resize(std::min(size, last));
+}
+
+bool PhysicsWorld::destroyBody(BodyHandle handle)
+{
+  int body = bodyIndex(handle);
+  if (body < 0)
+    return false;
+
+  // Contacts and broadphase state still refer to the indices of the last
+  // step; remember which body each of those indices held.
+  if (!bodiesDestroyed)
+  {
+    int stepped = static_cast<int>(transforms.size());
+    steppedHandles.resize(stepped);
+    for (int i = 0; i < stepped; i++)
+    {
+      steppedHandles[i] = bodyHandle(i);
+    }
+    bodiesDestroyed = true;
+  }
+
+  int last = bodyCount() - 1;
+  swapRemove(positions, body, last);
+  swapRemove(rotations, body, last);
+  swapRemove(linearVelocities, body, last);
+  swapRemove(angularVelocities, body, last);
+  swapRemove(forces, body, last);
+  swapRemove(torques, body, last);
+  swapRemove(shapes, body, last);
+  swapRemove(widths, body, last);
+  swapRemove(heights, body, last);
+  swapRemove(masses, body, last);
+  swapRemove(inverseMasses, body, last);
+  swapRemove(inertias, body, last);
+  swapRemove(inverseInertias, body, last);
+  swapRemove(restitutions, body, last);
+  swapRemove(frictions, body, last);
+  swapRemove(staticFlags, body, last);
+  swapRemove(awakeFlags, body, last);
+  swapRemove(sleepTimes, body, last);
+  swapRemove(bulletFlags, body, last);
+  swapRemove(previousPositions, body, last);
+  swapRemove(previousRotations, body, last);
+  swapRemove(transforms, body, last);
+  swapRemove(bounds, body, last);
+  swapRemove(reaches, body, last);
+
+  slotBodies[bodySlots[last]] = body;
+  slotBodies[handle.slot] = -1;
+  slotGenerations[handle.slot]++;
+  freeSlots.push_back(handle.slot);
+  swapRemove(bodySlots, body, last);
+  return true;
+}
+
+int PhysicsWorld::bodyCount() const
+{
+  return static_cast<int>(positions.size());
+}
+
+int PhysicsWorld::bodyIndex(BodyHandle body) const
+{
+  if (!isValid(body))
+    return -1;
+
+  return slotBodies[body.slot];
+}
+
+BodyHandle PhysicsWorld::bodyHandle(int body) const
+{
+  int slot = bodySlots[body];
+  return BodyHandle{slot, slotGenerations[slot]};
+}
+
+bool PhysicsWorld::isValid(BodyHandle body) const
+{
+  return body.slot >= 0 && body.slot < static_cast<int>(slotBodies.size()) && slotGenerations[body.slot] == body.generation && slotBodies[body.slot] >= 0;
+}
+
+// The solver reads the velocities of static bodies like any other, so a
+// body made static is also stopped.
+void PhysicsWorld::setStatic(int body, bool isStatic)
+{
+  staticFlags[body] = isStatic ? 1 : 0;
+  if (isStatic)
+  {
+    linearVelocities[body] = glm::vec2(0.0f, 0.0f);
+    angularVelocities[body] = 0.0f;
+  }
+  updateMassData(body);
+  setAwake(body, true);
+}
+
+void PhysicsWorld::setMass(int body, float mass)
+{
+  masses[body] = mass;
+  updateMassData(body);
+}
+
+void PhysicsWorld::setSize(int body, float width, float height)
+{
+  widths[body] = width;
+  heights[body] = height;
+  updateMassData(body);
+}
+
+// Inertia about the center of a solid box, m (w^2 + h^2) / 12, or of a
+// solid disc, m r^2 / 2.
+void PhysicsWorld::updateMassData(int body)
+{
+  float mass = masses[body];
+  if (shapes[body] == ShapeType::Circle)
+  {
+    inertias[body] = mass * widths[body] * widths[body] / 8.0f;
+  }
+  else
+  {
+    inertias[body] = mass * (widths[body] * widths[body] + heights[body] * heights[body]) / 12.0f;
+  }
+
+  bool dynamic = !staticFlags[body] && mass > 0.0f;
+  inverseMasses[body] = dynamic ? 1.0f / mass : 0.0f;
+  inverseInertias[body] = dynamic && inertias[body] > 0.0f ? 1.0f / inertias[body] : 0.0f;
+}
+
+void PhysicsWorld::setAwake(int body, bool awake)
+{
+  awakeFlags[body] = awake ? 1 : 0;
+  sleepTimes[body] = 0.0f;
+  if (!awake)
+  {
+    linearVelocities[body] = glm::vec2(0.0f, 0.0f);
+    angularVelocities[body] = 0.0f;
+  }
+}
+
+bool PhysicsWorld::isAwake(int body) const
+{
+  return awakeFlags[body] != 0;
+}
+
+void PhysicsWorld::setBullet(int body, bool bullet)
+{
+  bulletFlags[body] = bullet ? 1 : 0;
+}
+
+void PhysicsWorld::applyForce(int body, glm::vec2 force)
+{
+  setAwake(body, true);
+  forces[body] += force;
+}
+
+void PhysicsWorld::applyForce(int body, glm::vec2 force, glm::vec2 point)
+{
+  setAwake(body, true);
+  forces[body] += force;
+
+  glm::vec2 offset = point - positions[body];
+  torques[body] += offset.x * force.y - offset.y * force.x;
+}
+
+void PhysicsWorld::applyTorque(int body, float torqueAdd)
+{
+  setAwake(body, true);
+  torques[body] += torqueAdd;
+}
+
+// Contacts are found from the poses left by the previous step and grouped
+// into islands. Each island then integrates and solves on its own, after
+// which bullets are swept back to their first impact. Islands that have come
+// to rest go to sleep last.
+void PhysicsWorld::step(double deltaTime)
+{
+  TRACE_SCOPE("step");
+  float dt = static_cast<float>(deltaTime);
+  PHYSICS_PROFILE_ONLY(ProfileTimer timer);
+  frameArena.reset();
+  threadPool->resetArenas();
+  if (bodyCount() > reservedBodyCount)
+  {
+    reserveStepStorage();
+  }
+
+  updateContacts(dt);
+  PHYSICS_PROFILE_ONLY(timer.lap());
+  buildIslands();
+  PHYSICS_PROFILE_ONLY(stepProfile.islands = timer.lap());
+  beginSweeps();
+  solveContacts(dt);
+  clearForces();
+  PHYSICS_PROFILE_ONLY(stepProfile.solver = timer.lap());
+  solveContinuous();
+  PHYSICS_PROFILE_ONLY(stepProfile.continuous = timer.lap());
+  updateSleep(dt);
+  PHYSICS_PROFILE_ONLY(stepProfile.sleep = timer.lap());
+
+#if PHYSICS_PROFILE
+  stepProfile.total = timer.total();
+  stepProfile.contacts = static_cast<int>(contactCache.contacts.size());
+  stepProfile.awakeIslands = islandBuilder.awakeIslandCount;
+  stepProfile.islandCount = static_cast<int>(islandBuilder.islands.size());
+  stepProfile.awakeBodies = 0;
+  for (int i = 0; i < bodyCount(); i++)
+  {
+    stepProfile.awakeBodies += awakeFlags[i] && !staticFlags[i] ? 1 : 0;
+  }
+#endif
+}
+
+int PhysicsWorld::advance(double frameTime)
+{
+  accumulator += frameTime;
+
+  int steps = 0;
+  while (accumulator >= fixedTimeStep && steps < maxSubSteps)
+  {
+    previousPositions.assign(positions.begin(), positions.end());
+    previousRotations.assign(rotations.begin(), rotations.end());
+
+    step(fixedTimeStep);
+    accumulator -= fixedTimeStep;
+    steps++;
+  }
+
+  if (accumulator >= fixedTimeStep)
+  {
+    accumulator = std::fmod(accumulator, fixedTimeStep);
+  }
+
+  return steps;
+}
+
+float PhysicsWorld::interpolationAlpha() const
+{
+  return static_cast<float>(accumulator / fixedTimeStep);
+}
+
+glm::vec2 PhysicsWorld::interpolatedPosition(int body) const
+{
+  float alpha = interpolationAlpha();
+  return previousPositions[body] * (1.0f - alpha) + positions[body] * alpha;
+}
+
+float PhysicsWorld::interpolatedRotation(int body) const
+{
+  float alpha = interpolationAlpha();
+  return previousRotations[body] * (1.0f - alpha) + rotations[body] * alpha;
+}
+
+// Uses the bounds from the last step, so bodies added since then are not
+// reported until the world has stepped once, and after destroying bodies the
+// indices reported are only current once the world has stepped. The bounds
+// include the speculative margin, so bodies just short of the box may be
+// reported too. Like Broadphase::query, appends to bodies.
+void PhysicsWorld::queryAABB(const AABB &box, std::vector<int> &bodies) const
+{
+  broadphase->query(box, bounds, bodies);
+}
+
+const StepProfile &PhysicsWorld::profile() const
+{
+  return stepProfile;
+}
+
+const std::vector<Contact> &PhysicsWorld::getContacts() const
+{
+  return contactCache.contacts;
+}
+
+// Like integratePositions, works on the island bodies in [begin, end) of
+// islandBuilder.bodies.
+void PhysicsWorld::integrateVelocities(int begin, int end, float deltaTime)
+{
+  for (int i = begin; i < end; i++)
+  {
+    int body = islandBuilder.bodies[i];
+    linearVelocities[body] += (gravity + forces[body] * inverseMasses[body]) * deltaTime;
+    angularVelocities[body] += torques[body] * inverseInertias[body] * deltaTime;
+  }
+}
+
+void PhysicsWorld::clearForces()
+{
+  std::fill(forces.begin(), forces.end(), glm::vec2(0.0f, 0.0f));
+  std::fill(torques.begin(), torques.end(), 0.0f);
+}
+
+// Integrates the island bodies in [begin, end) of islandBuilder.bodies.
+// Every awake dynamic body belongs to exactly one awake island, so
+// integrating island by island covers them all.
+void PhysicsWorld::integratePositions(int begin, int end, float deltaTime)
+{
+  for (int i = begin; i < end; i++)
+  {
+    int body = islandBuilder.bodies[i];
+    positions[body] += linearVelocities[body] * deltaTime;
+    rotations[body] += glm::degrees(angularVelocities[body] * deltaTime);
+  }
+}
+
+// Brings everything still indexed by the last step's body indices up to
+// date with the destroys since: broadphase state is remapped, and contacts
+// with a destroyed body are dropped after waking the body on the other side.
+// A remapped contact whose bodies changed order is flipped so pairs keep
+// a < b.
+void PhysicsWorld::remapDestroyedBodies()
+{
+  int stepped = static_cast<int>(steppedHandles.size());
+  remappedBodies.resize(stepped);
+  for (int i = 0; i < stepped; i++)
+  {
+    remappedBodies[i] = bodyIndex(steppedHandles[i]);
+  }
+
+  broadphase->remapBodies(remappedBodies, bodyCount());
+
+  std::vector<Contact> &contacts = contactCache.contacts;
+  int kept = 0;
+  for (Contact &contact : contacts)
+  {
+    int a = remappedBodies[contact.a];
+    int b = remappedBodies[contact.b];
+    if (a < 0 || b < 0)
+    {
+      if (a >= 0 && !staticFlags[a])
+        setAwake(a, true);
+      if (b >= 0 && !staticFlags[b])
+        setAwake(b, true);
+      continue;
+    }
+
+    contact.a = std::min(a, b);
+    contact.b = std::max(a, b);
+    if (a > b)
+    {
+      Manifold &manifold = contact.manifold;
+      manifold.normal = -manifold.normal;
+      for (int i = 0; i < manifold.pointCount; i++)
+      {
+        manifold.points[i].tangentImpulse = -manifold.points[i].tangentImpulse;
+      }
+    }
+    contacts[kept++] = contact;
+  }
+  contacts.resize(kept);
+
+  bodiesDestroyed = false;
+}
+
+// Refreshes the per-step transform cache. Everything downstream of
+// integration (bounds, pair tests) reads corners and normals from here.
+// Sleeping bodies have not moved, so their entries are left as they are.
+// Reserves for half again as many bodies as there are, so a world that keeps
+// growing only reserves now and then. The arenas get room for what a step
+// takes from them at those counts, plus the padding between allocations.
+// Each worker solves whole islands, and stealing can hand one worker more
+// than its share, so each gets room for twice its share of the constraints.
+void PhysicsWorld::reserveStepStorage()
+{
+  reservedBodyCount = std::max(bodyCount(), reservedBodyCount + reservedBodyCount / 2);
+  int pairCapacity = pairsPerBody * reservedBodyCount;
+  int contactCapacity = contactsPerBody * reservedBodyCount;
+
+  transforms.reserve(reservedBodyCount);
+  bounds.reserve(reservedBodyCount);
+  reaches.reserve(reservedBodyCount);
+  sweepCandidates.reserve(reservedBodyCount);
+  pairs.reserve(pairCapacity);
+  broadphase->reserve(reservedBodyCount);
+  contactCache.reserve(contactCapacity);
+  islandBuilder.reserve(reservedBodyCount, contactCapacity);
+  constraintGraph.reserve(reservedBodyCount, contactCapacity);
+  solver.reserve(reservedBodyCount);
+
+  size_t padding = 16 * sizeof(std::max_align_t);
+  size_t constraintBytes = sizeof(ContactConstraint) * contactCapacity;
+  size_t pairBytes = (sizeof(BodyPair) + sizeof(SatResult)) * pairCapacity;
+  size_t bodyBytes = (2 * sizeof(int) + sizeof(Sweep)) * reservedBodyCount;
+  frameArena.reserve(pairBytes + constraintBytes + bodyBytes + padding);
+
+  int workers = workerCount();
+  size_t workerBytes = workers > 1 ? 2 * constraintBytes / workers : constraintBytes;
+  threadPool->reserveArenas(std::min(workerBytes, constraintBytes) + padding);
+}
+
+void PhysicsWorld::updateTransforms()
+{
+  int count = bodyCount();
+  int cached = static_cast<int>(transforms.size());
+  transforms.resize(count);
+  for (int i = 0; i < count; i++)
+  {
+    if (i < cached && !awakeFlags[i])
+      continue;
+
+    transforms[i] = computeBoxTransform(positions[i], rotations[i], widths[i], heights[i]);
+  }
+}
+
+static AABB boxBounds(const BoxTransform &transform)
+{
+  glm::vec2 extent = glm::abs(transform.axisX) * transform.halfExtents.x + glm::abs(transform.axisY) * transform.halfExtents.y;
+  return AABB{transform.center - extent, transform.center + extent};
+}
+
+// Bounds are grown by half the speculative margin and by how far the body can
+// move this step, so any pair that gets a speculative contact reaches the
+// narrowphase. Turning a circle does not move its
+// surface, and its bounds do not depend on its rotation.
+void PhysicsWorld::computeBounds(float deltaTime)
+{
+  int count = bodyCount();
+  int cached = static_cast<int>(bounds.size());
+  bounds.resize(count);
+  reaches.resize(count);
+  for (int i = 0; i < count; i++)
+  {
+    if (i < cached && !awakeFlags[i])
+      continue;
+
+    const BoxTransform &transform = transforms[i];
+    bool circle = shapes[i] == ShapeType::Circle;
+    float radius = circle ? 0.0f : glm::length(transform.halfExtents);
+    float reach = (glm::length(linearVelocities[i]) + std::abs(angularVelocities[i]) * radius) * deltaTime;
+    reaches[i] = staticFlags[i] ? 0.0f : std::min(reach, maxSpeculativeDistance);
+
+    glm::vec2 growth = glm::vec2(0.5f * speculativeMargin + reaches[i]);
+    AABB box = circle ? AABB{transform.center - transform.halfExtents, transform.center + transform.halfExtents} : boxBounds(transform);
+    bounds[i] = AABB{box.min - growth, box.max + growth};
+  }
+}
+
+void PhysicsWorld::updateContacts(float deltaTime)
+{
+  TRACE_SCOPE("updateContacts");
+  PHYSICS_PROFILE_ONLY(ProfileTimer timer);
+  if (bodiesDestroyed)
+  {
+    remapDestroyedBodies();
+  }
+  updateTransforms();
+  computeBounds(deltaTime);
+  broadphase->findPairs(bounds, pairs);
+  // The broadphase reports pairs in whatever order its sweep or traversal
+  // meets them, which changes as bodies move. The solver's results depend on
+  // the order it visits contacts in, so sort the pairs to keep that order
+  // from drifting with every small motion.
+  std::sort(pairs.begin(), pairs.end(), [](const BodyPair &first, const BodyPair &second)
+            { return first.a != second.a ? first.a < second.a : first.b < second.b; });
+  PHYSICS_PROFILE_ONLY(stepProfile.broadphase = timer.lap());
+  PHYSICS_PROFILE_ONLY(stepProfile.candidatePairs = static_cast<int>(pairs.size()));
+  contactCache.beginStep();
+
+  // Pairs where neither body can move keep last step's contact as it was,
+  // so a sleeping pile stays connected. Of the rest, box pairs are compacted
+  // to the front of the list for the batched SAT kernel and pairs with a
+  // circle go to their own list.
+  circlePairs = frameArena.allocate<BodyPair>(static_cast<int>(pairs.size()));
+  circlePairCount = 0;
+  int pairCount = 0;
+  for (const BodyPair &pair : pairs)
+  {
+    bool movingA = !staticFlags[pair.a] && awakeFlags[pair.a];
+    bool movingB = !staticFlags[pair.b] && awakeFlags[pair.b];
+    if ((movingA || movingB) && shapes[pair.a] == ShapeType::Box && shapes[pair.b] == ShapeType::Box)
+    {
+      pairs[pairCount++] = pair;
+    }
+    else if (movingA || movingB)
+    {
+      circlePairs[circlePairCount++] = pair;
+    }
+    else if (!staticFlags[pair.a] || !staticFlags[pair.b])
+    {
+      contactCache.keep(pair.a, pair.b);
+    }
+  }
+
+  // The batched SAT kernel filters the broadphase pairs. Pairs that overlap,
+  // or are separated by less than the margin plus the distance they can
+  // close this step, get a clipped manifold; points not yet touching become
+  // speculative contacts that only stop the bodies from closing the gap too
+  // fast.
+  satResults = frameArena.allocate<SatResult>(pairCount);
+  collideBoxesBatch(transforms.data(), pairs.data(), pairCount, satResults);
+  PHYSICS_PROFILE_ONLY(stepProfile.satAxesTested = 4 * pairCount);
+
+  for (int i = 0; i < pairCount; i++)
+  {
+    int a = pairs[i].a;
+    int b = pairs[i].b;
+    float speculativeDistance = std::min(speculativeMargin + reaches[a] + reaches[b], maxSpeculativeDistance);
+    if (satResults[i].overlap < -speculativeDistance)
+      continue;
+
+    Manifold manifold;
+    PHYSICS_PROFILE_ONLY(stepProfile.satAxesTested += 4);
+    if (collideBoxesManifold(transforms[a], transforms[b], manifold, speculativeDistance) > 0)
+    {
+      addContact(a, b, manifold);
+    }
+  }
+
+  // Circles need no SAT: their tests are a distance check, or a clamp of
+  // the circle's center into the box's frame.
+  for (int i = 0; i < circlePairCount; i++)
+  {
+    int a = circlePairs[i].a;
+    int b = circlePairs[i].b;
+    float speculativeDistance = std::min(speculativeMargin + reaches[a] + reaches[b], maxSpeculativeDistance);
+
+    const BoxTransform &transformA = transforms[a];
+    const BoxTransform &transformB = transforms[b];
+    Manifold manifold;
+    int points;
+    if (shapes[a] == ShapeType::Circle && shapes[b] == ShapeType::Circle)
+    {
+      points = collideCirclesManifold(transformA.center, transformA.halfExtents.x, transformB.center, transformB.halfExtents.x, manifold, speculativeDistance);
+    }
+    else if (shapes[a] == ShapeType::Box)
+    {
+      points = collideBoxCircleManifold(transformA, transformB.center, transformB.halfExtents.x, manifold, speculativeDistance);
+    }
+    else
+    {
+      points = collideBoxCircleManifold(transformB, transformA.center, transformA.halfExtents.x, manifold, speculativeDistance);
+      manifold.normal = -manifold.normal;
+    }
+
+    if (points > 0)
+    {
+      addContact(a, b, manifold);
+    }
+  }
+
+  PHYSICS_PROFILE_ONLY(stepProfile.narrowphase = timer.lap());
+}
+
+void PhysicsWorld::addContact(int a, int b, const Manifold &manifold)
+{
+  contactCache.add(a, b, manifold);
+
+  // A moving body touching a sleeping one wakes it, and through the island
+  // pass the rest of its island.
+  if (!staticFlags[a] && !awakeFlags[a])
+    setAwake(a, true);
+  if (!staticFlags[b] && !awakeFlags[b])
+    setAwake(b, true);
+}
+
+void PhysicsWorld::buildIslands()
+{
+  TRACE_SCOPE("buildIslands");
+  islandBuilder.build(staticFlags, awakeFlags, contactCache.contacts);
+
+  for (int i = 0; i < islandBuilder.awakeIslandCount; i++)
+  {
+    const Island &island = islandBuilder.islands[i];
+    for (int j = 0; j < island.bodyCount; j++)
+    {
+      int body = islandBuilder.bodies[island.bodyBegin + j];
+      if (!awakeFlags[body])
+        setAwake(body, true);
+    }
+  }
+}
+
+// Only awake islands are solved. Islands share no dynamic bodies, so each
+// small island is solved start to finish as a single job and the thread pool
+// spreads them across its workers. Large islands would leave the other
+// workers idle, so they are graph colored and each of their passes is split
+// across the pool one color at a time.
+void PhysicsWorld::solveContacts(float deltaTime)
+{
+  TRACE_SCOPE("solveContacts");
+  solver.reset(*this, deltaTime);
+  solverDeltaTime = deltaTime;
+  if (solverMode == SolverMode::SoftStep)
+  {
+    solver.setSoftness(deltaTime / solverSubSteps, contactHertz, contactDampingRatio, maxContactPushVelocity);
+  }
+
+  int awakeIslands = islandBuilder.awakeIslandCount;
+  parallelIslands = frameArena.allocate<int>(awakeIslands);
+  coloredIslands = frameArena.allocate<int>(awakeIslands);
+  parallelIslandCount = 0;
+  coloredIslandCount = 0;
+  for (int i = 0; i < awakeIslands; i++)
+  {
+    if (islandBuilder.islands[i].contactCount >= graphColoringThreshold)
+    {
+      coloredIslands[coloredIslandCount++] = i;
+    }
+    else
+    {
+      parallelIslands[parallelIslandCount++] = i;
+    }
+  }
+
+  int grainSize = std::max(1, parallelIslandCount / (threadPool->workerCount() * 4));
+  threadPool->parallelFor(parallelIslandCount, grainSize, solveIslandsJob, this);
+
+  for (int i = 0; i < coloredIslandCount; i++)
+  {
+    solveColoredIsland(islandBuilder.islands[coloredIslands[i]]);
+  }
+}
+
+void PhysicsWorld::solveIslandsJob(void *context, int begin, int end, int worker)
+{
+  TRACE_SCOPE("solveIslands");
+  PhysicsWorld *world = static_cast<PhysicsWorld *>(context);
+  FrameArena &arena = world->threadPool->arena(worker);
+  for (int i = begin; i < end; i++)
+  {
+    world->solveIsland(world->islandBuilder.islands[world->parallelIslands[i]], world->solverDeltaTime, arena);
+  }
+}
+
+// The island's constraints only live for this call, so they come from the
+// arena of the worker solving it.
+void PhysicsWorld::solveIsland(const Island &island, float deltaTime, FrameArena &arena)
+{
+  int begin = island.contactBegin;
+  int end = begin + island.contactCount;
+  int count = island.contactCount;
+  int bodyBegin = island.bodyBegin;
+  int bodyEnd = bodyBegin + island.bodyCount;
+  ContactConstraint *constraints = arena.allocate<ContactConstraint>(count);
+
+  if (solverMode == SolverMode::SoftStep)
+  {
+    float subStep = deltaTime / solverSubSteps;
+    solver.prepare(contactCache.contacts, begin, end, constraints);
+
+    for (int i = 0; i < solverSubSteps; i++)
+    {
+      integrateVelocities(bodyBegin, bodyEnd, subStep);
+      if (warmStarting)
+      {
+        solver.warmStart(constraints, count);
+      }
+      solver.solveSoft(constraints, count, true);
+      integratePositions(bodyBegin, bodyEnd, subStep);
+      solver.solveSoft(constraints, count, false);
+    }
+
+    solver.applyRestitution(constraints, count);
+    solver.storeImpulses(constraints, contactCache.contacts, begin, end);
+    return;
+  }
+
+  integrateVelocities(bodyBegin, bodyEnd, deltaTime);
+  solver.prepare(contactCache.contacts, begin, end, constraints);
+  if (warmStarting)
+  {
+    solver.warmStart(constraints, count);
+  }
+
+  for (int i = 0; i < velocityIterations; i++)
+  {
+    solver.solveVelocities(constraints, count);
+  }
+
+  integratePositions(bodyBegin, bodyEnd, deltaTime);
+
+  for (int i = 0; i < positionIterations; i++)
+  {
+    solver.solvePositions(constraints, count);
+  }
+
+  solver.storeImpulses(constraints, contactCache.contacts, begin, end);
+}
+
+// Same passes as solveIsland, but every pass is spread over the pool. The
+// contacts of one color share no dynamic body, so the result does not
+// depend on how many workers there are.
+void PhysicsWorld::solveColoredIsland(const Island &island)
+{
+  TRACE_SCOPE("solveColoredIsland");
+  int begin = island.contactBegin;
+  int end = begin + island.contactCount;
+  int bodyBegin = island.bodyBegin;
+  int bodyEnd = bodyBegin + island.bodyCount;
+  constraintGraph.color(staticFlags, contactCache.contacts, begin, end);
+
+  // Each pass splits the constraints differently across the workers, so
+  // they live in the world's arena rather than any one worker's.
+  coloredConstraints = frameArena.allocate<ContactConstraint>(island.contactCount);
+  coloredContactBegin = begin;
+
+  if (solverMode == SolverMode::SoftStep)
+  {
+    integrationStep = solverDeltaTime / solverSubSteps;
+    runStage(SolverStage::Prepare, begin, end);
+
+    for (int i = 0; i < solverSubSteps; i++)
+    {
+      runStage(SolverStage::IntegrateVelocities, bodyBegin, bodyEnd);
+      if (warmStarting)
+      {
+        runColoredStage(SolverStage::WarmStart);
+      }
+      runColoredStage(SolverStage::SoftSolve);
+      runStage(SolverStage::Integrate, bodyBegin, bodyEnd);
+      runColoredStage(SolverStage::SoftRelax);
+    }
+
+    runColoredStage(SolverStage::Restitution);
+    runStage(SolverStage::StoreImpulses, begin, end);
+    return;
+  }
+
+  integrationStep = solverDeltaTime;
+  runStage(SolverStage::IntegrateVelocities, bodyBegin, bodyEnd);
+  runStage(SolverStage::Prepare, begin, end);
+  if (warmStarting)
+  {
+    runColoredStage(SolverStage::WarmStart);
+  }
+
+  for (int i = 0; i < velocityIterations; i++)
+  {
+    runColoredStage(SolverStage::Velocities);
+  }
+
+  runStage(SolverStage::Integrate, bodyBegin, bodyEnd);
+
+  for (int i = 0; i < positionIterations; i++)
+  {
+    runColoredStage(SolverStage::Positions);
+  }
+
+  runStage(SolverStage::StoreImpulses, begin, end);
+}
+
+void PhysicsWorld::runStage(SolverStage stage, int begin, int end)
+{
+  StageJob job{this, stage, begin};
+  int count = end - begin;
+  int grainSize = std::max(64, count / (threadPool->workerCount() * 4));
+  threadPool->parallelFor(count, grainSize, stageJob, &job);
+}
+
+void PhysicsWorld::runColoredStage(SolverStage stage)
+{
+  const int *starts = constraintGraph.colorStarts;
+  for (int c = 0; c < ConstraintGraph::maxColors; c++)
+  {
+    if (starts[c + 1] > starts[c])
+    {
+      runStage(stage, starts[c], starts[c + 1]);
+    }
+  }
+
+  // The overflow contacts may share bodies, so they stay on this thread.
+  StageJob job{this, stage, starts[ConstraintGraph::maxColors]};
+  stageJob(&job, 0, starts[ConstraintGraph::maxColors + 1] - job.offset, 0);
+}
+
+void PhysicsWorld::stageJob(void *context, int begin, int end, int)
+{
+  TRACE_SCOPE("solverStage");
+  const StageJob &job = *static_cast<const StageJob *>(context);
+  PhysicsWorld &world = *job.world;
+  begin += job.offset;
+  end += job.offset;
+
+  // Solver stages run over contacts, the integrate stages over bodies.
+  ContactConstraint *constraints = world.coloredConstraints + (begin - world.coloredContactBegin);
+  int count = end - begin;
+
+  switch (job.stage)
+  {
+  case SolverStage::Prepare:
+    world.solver.prepare(world.contactCache.contacts, begin, end, constraints);
+    break;
+  case SolverStage::WarmStart:
+    world.solver.warmStart(constraints, count);
+    break;
+  case SolverStage::Velocities:
+    world.solver.solveVelocities(constraints, count);
+    break;
+  case SolverStage::Positions:
+    world.solver.solvePositions(constraints, count);
+    break;
+  case SolverStage::StoreImpulses:
+    world.solver.storeImpulses(constraints, world.contactCache.contacts, begin, end);
+    break;
+  case SolverStage::IntegrateVelocities:
+    world.integrateVelocities(begin, end, world.integrationStep);
+    break;
+  case SolverStage::Integrate:
+    world.integratePositions(begin, end, world.integrationStep);
+    break;
+  case SolverStage::SoftSolve:
+    world.solver.solveSoft(constraints, count, true);
+    break;
+  case SolverStage::SoftRelax:
+    world.solver.solveSoft(constraints, count, false);
+    break;
+  case SolverStage::Restitution:
+    world.solver.applyRestitution(constraints, count);
+    break;
+  }
+}
+
+// An island sleeps as a unit once its most recently moving body has been at
+// rest for timeToSleep, so a pile never sleeps around a body still settling.
+void PhysicsWorld::updateSleep(float deltaTime)
+{
+  TRACE_SCOPE("updateSleep");
+  if (!allowSleep)
+    return;
+
+  float linearLimit = sleepLinearVelocity * sleepLinearVelocity;
+
+  for (int i = 0; i < islandBuilder.awakeIslandCount; i++)
+  {
+    const Island &island = islandBuilder.islands[i];
+    float minSleepTime = FLT_MAX;
+
+    for (int j = 0; j < island.bodyCount; j++)
+    {
+      int body = islandBuilder.bodies[island.bodyBegin + j];
+      glm::vec2 velocity = linearVelocities[body];
+      if (glm::dot(velocity, velocity) > linearLimit || std::abs(angularVelocities[body]) > sleepAngularVelocity)
+      {
+        sleepTimes[body] = 0.0f;
+      }
+      else
+      {
+        sleepTimes[body] += deltaTime;
+      }
+      minSleepTime = std::min(minSleepTime, sleepTimes[body]);
+    }
+
+    if (minSleepTime >= timeToSleep)
+    {
+      for (int j = 0; j < island.bodyCount; j++)
+      {
+        setAwake(islandBuilder.bodies[island.bodyBegin + j], false);
+      }
+    }
+  }
+}
+
+void PhysicsWorld::beginSweeps()
+{
+  int count = bodyCount();
+  sweepCount = 0;
+  for (int i = 0; i < count; i++)
+  {
+    sweepCount += bulletFlags[i] && awakeFlags[i] && !staticFlags[i] ? 1 : 0;
+  }
+
+  sweeps = frameArena.allocate<Sweep>(sweepCount);
+  sweepCount = 0;
+  for (int i = 0; i < count; i++)
+  {
+    if (bulletFlags[i] && awakeFlags[i] && !staticFlags[i])
+    {
+      sweeps[sweepCount++] = Sweep{i, positions[i], rotations[i]};
+    }
+  }
+}
+
+// Each bullet is swept against every other body at that body's final pose,
+// other bullets aside, and moved back to the earliest impact. The bullet
+// keeps its velocity and stops just inside the surface, so next step's
+// narrowphase finds the contact and the solver handles the response.
+// Bodies the bullet already touched at the start of the step are left to
+// the solver; sweeping them would pin a bullet sliding along a surface.
+// Circles, bullet or obstacle, are swept as circles rather than as the
+// boxes around them.
+void PhysicsWorld::solveContinuous()
+{
+  TRACE_SCOPE("solveContinuous");
+  float target = -0.5f * linearSlop;
+
+  for (int i = 0; i < sweepCount; i++)
+  {
+    const Sweep &sweep = sweeps[i];
+    int body = sweep.body;
+    ShapeType shape = shapes[body];
+    float width = widths[body];
+    float height = heights[body];
+
+    // A bullet that moved less than a quarter of its size can not have
+    // skipped over anything it did not also overlap.
+    glm::vec2 translation = positions[body] - sweep.position;
+    float turn = rotations[body] - sweep.rotation;
+    float radius = shape == ShapeType::Circle ? 0.0f : 0.5f * std::sqrt(width * width + height * height);
+    if (glm::length(translation) + std::abs(glm::radians(turn)) * radius < 0.25f * std::min(width, height))
+      continue;
+
+    BoxTransform start = computeBoxTransform(sweep.position, sweep.rotation, width, height);
+    BoxTransform end = computeBoxTransform(positions[body], rotations[body], width, height);
+    sweepCandidates.clear();
+    broadphase->query(aabbUnion(boxBounds(start), boxBounds(end)), bounds, sweepCandidates);
+
+    float impactTime = 1.0f;
+    for (int other : sweepCandidates)
+    {
+      if (other == body || (bulletFlags[other] && !staticFlags[other]))
+        continue;
+
+      BoxTransform obstacle = computeBoxTransform(positions[other], rotations[other], widths[other], heights[other]);
+      if (shapeSeparation(start, shape, obstacle, shapes[other]) <= linearSlop)
+        continue;
+
+      float time = timeOfImpact(sweep.position, sweep.rotation, positions[body], rotations[body], width, height, shape, obstacle, shapes[other], target);
+      impactTime = std::min(impactTime, time);
+    }
+
+    if (impactTime < 1.0f)
+    {
+      positions[body] = sweep.position + translation * impactTime;
+      rotations[body] = sweep.rotation + turn * impactTime;
+    }
+  }
+}
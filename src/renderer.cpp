@@ -1,4 +1,5 @@
 #include "Includes/renderer.h"
+#include "Includes/trace.h"
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <iostream>
@@ -33,12 +34,17 @@ bool Renderer::rendering()
 
 void Renderer::displayFrame()
 {
-  glfwSwapBuffers(window);
+  {
+    TRACE_SCOPE("glfwSwapBuffers");
+    glfwSwapBuffers(window);
+  }
+  TRACE_SCOPE("glfwPollEvents");
   glfwPollEvents();
 }
 
 void Renderer::displayBackground(float r, float g, float b, float a)
 {
+  TRACE_SCOPE("displayBackground");
   glClearColor(r / 255, g / 255, b / 255, a);
   glClear(GL_COLOR_BUFFER_BIT);
 }
@@ -50,6 +56,7 @@ void Renderer::close()
 
 void Renderer::drawSquare(glm::vec2 position, glm::vec2 scale, float rotation, glm::vec4 color)
 {
+  TRACE_SCOPE("drawSquare");
   shader->use();
 
   glm::mat4 projection = glm::ortho(0.0f, static_cast<float>(ScreenW), 0.0f, static_cast<float>(ScreenH));
@@ -73,6 +80,7 @@ void Renderer::drawSquare(glm::vec2 position, glm::vec2 scale, float rotation, g
 
 void Renderer::drawVector(glm::vec2 startPosition, glm::vec2 vector, glm::vec4 color)
 {
+  TRACE_SCOPE("drawVector");
   shader->use();
 
   glm::mat4 projection = glm::ortho(0.0f, static_cast<float>(ScreenW), 0.0f, static_cast<float>(ScreenH));
@@ -100,6 +108,7 @@ void Renderer::drawVector(glm::vec2 startPosition, glm::vec2 vector, glm::vec4 c
 
 void Renderer::drawCircle(glm::vec2 position, glm::vec2 scale, float rotation, glm::vec4 color)
 {
+  TRACE_SCOPE("drawCircle");
   shader->use();
 
   glm::mat4 projection = glm::ortho(0.0f, static_cast<float>(ScreenW), 0.0f, static_cast<float>(ScreenH));
@@ -124,6 +133,7 @@ void Renderer::drawCircle(glm::vec2 position, glm::vec2 scale, float rotation, g
 
 void Renderer::renderText(std::string text, float x, float y, float scale, glm::vec3 color)
 {
+  TRACE_SCOPE("renderText");
   textShader->use();
   textShader->setVec3("textColor", color);
   glActiveTexture(GL_TEXTURE0);
@@ -1,140 +1,105 @@
 #include "Includes/rigidBody.h"
+#include "Includes/collision.h"
+#include <algorithm>
+#include <cmath>
 
-bool intervalsOverlap(float minA, float maxA, float minB, float maxB)
-{
-  return maxA >= minB && maxB >= minA;
-}
-
-float projectVertex(const glm::vec2 &vertex, const glm::vec2 &axis)
+RigidBody::RigidBody(glm::vec2 position, float rotation, float width, float height, float mass) : position(position), rotation(rotation), width(width), height(height), mass(mass)
 {
-  return glm::dot(vertex, axis);
+  updateMassData();
 }
 
-glm::vec2 computeEdgeNormal(const glm::vec2 &start, const glm::vec2 &end)
+void RigidBody::updateMassData()
 {
-  glm::vec2 edgeNormal = glm::vec2(end.y - start.y, start.x - end.x);
-  if (glm::length(edgeNormal) == 0.0f)
+  if (shape == ShapeType::Circle)
   {
-    return glm::vec2(0, 0);
+    inertia = mass * width * width / 8.0f;
+  }
+  else
+  {
+    inertia = mass * (width * width + height * height) / 12.0f;
   }
-  return glm::normalize(edgeNormal);
-}
-
-glm::vec2 getVertex(int index, RigidBody *rect)
-{
-  float halfWidth = rect->width / 2;
-  float halfHeight = rect->height / 2;
-
-  glm::vec2 localVertices[4];
-  localVertices[0] = glm::vec2(-halfWidth, halfHeight);
-  localVertices[1] = glm::vec2(halfWidth, halfHeight);
-  localVertices[2] = glm::vec2(halfWidth, -halfHeight);
-  localVertices[3] = glm::vec2(-halfWidth, -halfHeight);
-
-  glm::vec2 localVertex = localVertices[index];
-
-  float angle = glm::radians(rect->rotation);
-  glm::mat2 rotationMatrix = glm::mat2(
-      glm::cos(angle), -glm::sin(angle),
-      glm::sin(angle), glm::cos(angle));
-
-  glm::vec2 rotatedVertex = rotationMatrix * localVertex;
-
-  glm::vec2 worldVertex = rect->position + rotatedVertex;
-
-  return worldVertex;
-}
-
-glm::vec2 getNormal(int edgeIndex, RigidBody *rect)
-{
-  glm::vec2 start = getVertex(edgeIndex, rect);
-  glm::vec2 end = getVertex((edgeIndex + 1) % 4, rect);
-  return computeEdgeNormal(start, end);
-}
 
-RigidBody::RigidBody(glm::vec2 position, float rotation, float width, float height, float mass) : position(position), rotation(rotation), width(width), height(height), mass(mass)
-{
+  bool dynamic = !isStatic && mass > 0.0f;
+  inverseMass = dynamic ? 1.0f / mass : 0.0f;
+  inverseInertia = dynamic && inertia > 0.0f ? 1.0f / inertia : 0.0f;
 }
 
+// Static bodies only drop the forces applied to them. Their zero inverses
+// already keep them from accelerating, but a velocity set on one directly
+// would still move it.
 void RigidBody::update(double deltaTime)
 {
-  applyForce(GRAVITY * mass, glm::vec2(position.x, position.y));
-
   if (isStatic)
+  {
+    forceVector = glm::vec2(0.0f, 0.0f);
+    torque = 0.0f;
     return;
+  }
+
+  applyForce(GRAVITY * mass, glm::vec2(position.x, position.y));
 
-  glm::vec2 linearAcceleration = forceVector / mass;
+  glm::vec2 linearAcceleration = forceVector * inverseMass;
   linearVelocity += glm::vec2(linearAcceleration.x * deltaTime, linearAcceleration.y * deltaTime);
   position += glm::vec2(linearVelocity.x * deltaTime, linearVelocity.y * deltaTime);
 
-  float angularAcceleration = torque / mass;
+  float angularAcceleration = torque * inverseInertia;
   angularVelocity += angularAcceleration * deltaTime;
   rotation += angularVelocity * deltaTime;
 
   forceVector = glm::vec2(0.0f, 0.0f);
+  torque = 0.0f;
 }
 
-void RigidBody::resolveCollision(RigidBody *rectangle)
+// Pairs with a circle skip the SAT test; the circle manifold gives the same
+// axis, overlap and point directly.
+static bool collideWithCircle(const RigidBody &a, const RigidBody &b, SatResult &result)
 {
-  if (isStatic && rectangle->isStatic)
-    return;
-
-  float minOverlap = FLT_MAX;
-  glm::vec2 mtvAxis;
-  glm::vec2 collisionPoint;
-
-  for (int j = 0; j < 8; j++)
+  Manifold manifold;
+  int points;
+  if (a.shape == ShapeType::Circle && b.shape == ShapeType::Circle)
   {
-    glm::vec2 axis;
-    if (j < 4)
-    {
-      axis = getNormal(j, this);
-    }
-    else
-    {
-      axis = getNormal(j, rectangle);
-    }
+    points = collideCirclesManifold(a.position, 0.5f * a.width, b.position, 0.5f * b.width, manifold);
+  }
+  else if (a.shape == ShapeType::Box)
+  {
+    points = collideBoxCircleManifold(computeBoxTransform(a.position, a.rotation, a.width, a.height), b.position, 0.5f * b.width, manifold);
+  }
+  else
+  {
+    points = collideBoxCircleManifold(computeBoxTransform(b.position, b.rotation, b.width, b.height), a.position, 0.5f * a.width, manifold);
+  }
 
-    if (axis == glm::vec2(0.0f, 0.0f))
-      continue;
+  if (points == 0)
+    return false;
 
-    float minA, maxA, minB, maxB;
-    minA = maxA = projectVertex(getVertex(0, this), axis);
-    for (int i = 1; i < 4; i++)
-    {
-      float projection = projectVertex(getVertex(i, this), axis);
-      minA = std::min(minA, projection);
-      maxA = std::max(maxA, projection);
-    }
+  result.overlap = -manifold.points[0].separation;
+  result.axis = manifold.normal;
+  result.contactPoint = manifold.points[0].position;
+  return true;
+}
 
-    minB = maxB = projectVertex(getVertex(0, rectangle), axis);
-    for (int i = 1; i < 4; i++)
-    {
-      float projection = projectVertex(getVertex(i, rectangle), axis);
-      minB = std::min(minB, projection);
-      maxB = std::max(maxB, projection);
-    }
+void RigidBody::resolveCollision(RigidBody *rectangle)
+{
+  if (inverseMass + rectangle->inverseMass == 0.0f)
+    return;
 
-    if (!intervalsOverlap(minA, maxA, minB, maxB))
-    {
+  SatResult sat;
+  if (shape == ShapeType::Box && rectangle->shape == ShapeType::Box)
+  {
+    BoxTransform transformA = computeBoxTransform(position, rotation, width, height);
+    BoxTransform transformB = computeBoxTransform(rectangle->position, rectangle->rotation, rectangle->width, rectangle->height);
+    if (!collideBoxes(transformA, transformB, sat))
       return;
-    }
-
-    float overlapMin = std::max(minA, minB);
-    float overlapMax = std::min(maxA, maxB);
-
-    float overlap = std::max(0.0f, overlapMax - overlapMin);
-
-    if (overlap < minOverlap)
-    {
-      minOverlap = overlap;
-      mtvAxis = axis;
-      float overlapCenter = (overlapMin + overlapMax) / 2.0f;
-
-      collisionPoint = this->position + (overlapCenter - glm::dot(this->position, axis)) * axis;
-    }
+  }
+  else if (!collideWithCircle(*this, *rectangle, sat))
+  {
+    return;
   }
 
+  float minOverlap = sat.overlap;
+  glm::vec2 mtvAxis = sat.axis;
+  glm::vec2 collisionPoint = sat.contactPoint;
+
   if (minOverlap > 0.0f)
   {
     glm::vec2 mtv = mtvAxis * minOverlap;
@@ -144,16 +109,12 @@ void RigidBody::resolveCollision(RigidBody *rectangle)
       mtv *= -2;
     }
 
-    float momentOfInertia1 = (1.0f / 12.0f) * mass * (width * width + height * height);
-
-    float momentOfInertia2 = (1.0f / 12.0f) * rectangle->mass * (rectangle->width * rectangle->width + rectangle->height * rectangle->height);
-
     glm::vec2 relativeVelocity = rectangle->linearVelocity - this->linearVelocity;
     float restitution = std::min(this->restitution, rectangle->restitution);
 
     float velocityAlongNormal = glm::dot(relativeVelocity, mtvAxis);
 
-    float impulse = (-(1 + restitution) * velocityAlongNormal) / ((1 / this->mass) + (1 / rectangle->mass));
+    float impulse = (-(1 + restitution) * velocityAlongNormal) / (this->inverseMass + rectangle->inverseMass);
 
     glm::vec2 r1 = collisionPoint - this->position;
     glm::vec2 r2 = collisionPoint - rectangle->position;
@@ -163,14 +124,14 @@ void RigidBody::resolveCollision(RigidBody *rectangle)
 
     if ((abs(collisionPoint.x - this->position.x) < 0.1 || abs(collisionPoint.y - this->position.y) < 0.1 || abs(collisionPoint.x - rectangle->position.x) < 0.1 || abs(collisionPoint.y - rectangle->position.y) < 0.1) || this->rotation == 0 || rectangle->rotation == 0)
     {
-      this->angularVelocity += angularImpulse1 / momentOfInertia1;
-      rectangle->angularVelocity -= angularImpulse2 / momentOfInertia2;
+      this->angularVelocity += angularImpulse1 * this->inverseInertia;
+      rectangle->angularVelocity -= angularImpulse2 * rectangle->inverseInertia;
     }
 
     glm::vec2 impulseVector = impulse * mtvAxis;
 
-    this->linearVelocity -= impulseVector / this->mass;
-    rectangle->linearVelocity += impulseVector / rectangle->mass;
+    this->linearVelocity -= impulseVector * this->inverseMass;
+    rectangle->linearVelocity += impulseVector * rectangle->inverseMass;
 
     if (this->isStatic)
     {
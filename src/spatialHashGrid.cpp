@@ -0,0 +1,211 @@
+#include "Includes/spatialHashGrid.h"
+#include <cmath>
+#include <algorithm>
+
+SpatialHashGrid::SpatialHashGrid(float cellSize) : cellSize(cellSize)
+{
+}
+
+int SpatialHashGrid::cellCoordinate(float value) const
+{
+  return static_cast<int>(std::floor(value / cellSize));
+}
+
+static unsigned int hashCell(int x, int y)
+{
+  return static_cast<unsigned int>(x) * 73856093u ^ static_cast<unsigned int>(y) * 19349663u;
+}
+
+// Sizes the table to at least twice the number of entries so probe chains
+// stay short.
+void SpatialHashGrid::growTable(int entryCount)
+{
+  size_t required = 16;
+  while (required < static_cast<size_t>(entryCount) * 2)
+  {
+    required *= 2;
+  }
+
+  if (cells.size() < required)
+  {
+    cells.assign(required, Cell{0, 0, 0, 0, 0});
+    stamp = 0;
+  }
+}
+
+// Slots are invalidated by bumping the stamp instead of clearing.
+void SpatialHashGrid::prepareTable(int entryCount)
+{
+  growTable(entryCount);
+
+  stamp++;
+  if (stamp == 0)
+  {
+    for (Cell &cell : cells)
+    {
+      cell.stamp = 0;
+    }
+    stamp = 1;
+  }
+
+  usedCells.clear();
+}
+
+int SpatialHashGrid::findCell(int x, int y) const
+{
+  if (cells.empty())
+    return -1;
+
+  unsigned int mask = static_cast<unsigned int>(cells.size()) - 1;
+  unsigned int slot = hashCell(x, y) & mask;
+
+  while (cells[slot].stamp == stamp)
+  {
+    if (cells[slot].x == x && cells[slot].y == y)
+    {
+      return static_cast<int>(slot);
+    }
+    slot = (slot + 1) & mask;
+  }
+  return -1;
+}
+
+int SpatialHashGrid::findOrInsertCell(int x, int y)
+{
+  unsigned int mask = static_cast<unsigned int>(cells.size()) - 1;
+  unsigned int slot = hashCell(x, y) & mask;
+
+  while (true)
+  {
+    Cell &cell = cells[slot];
+    if (cell.stamp != stamp)
+    {
+      cell = Cell{x, y, 0, 0, stamp};
+      usedCells.push_back(static_cast<int>(slot));
+      return static_cast<int>(slot);
+    }
+    if (cell.x == x && cell.y == y)
+    {
+      return static_cast<int>(slot);
+    }
+    slot = (slot + 1) & mask;
+  }
+}
+
+void SpatialHashGrid::findPairs(const std::vector<AABB> &bounds, std::vector<BodyPair> &pairs)
+{
+  pairs.clear();
+
+  int bodyCount = static_cast<int>(bounds.size());
+  int entryCount = 0;
+  for (int i = 0; i < bodyCount; i++)
+  {
+    int spanX = cellCoordinate(bounds[i].max.x) - cellCoordinate(bounds[i].min.x) + 1;
+    int spanY = cellCoordinate(bounds[i].max.y) - cellCoordinate(bounds[i].min.y) + 1;
+    entryCount += spanX * spanY;
+  }
+
+  prepareTable(entryCount);
+  entries.resize(entryCount);
+  cellBodies.resize(entryCount);
+
+  // Count how many bodies land in each cell, remembering the slot per entry.
+  int entryIndex = 0;
+  for (int i = 0; i < bodyCount; i++)
+  {
+    int minX = cellCoordinate(bounds[i].min.x);
+    int minY = cellCoordinate(bounds[i].min.y);
+    int maxX = cellCoordinate(bounds[i].max.x);
+    int maxY = cellCoordinate(bounds[i].max.y);
+
+    for (int y = minY; y <= maxY; y++)
+    {
+      for (int x = minX; x <= maxX; x++)
+      {
+        int slot = findOrInsertCell(x, y);
+        cells[slot].count++;
+        entries[entryIndex++] = Entry{slot, i};
+      }
+    }
+  }
+
+  int offset = 0;
+  for (int slot : usedCells)
+  {
+    cells[slot].start = offset;
+    offset += cells[slot].count;
+    cells[slot].count = 0;
+  }
+
+  for (const Entry &entry : entries)
+  {
+    Cell &cell = cells[entry.cell];
+    cellBodies[cell.start + cell.count++] = entry.body;
+  }
+
+  // A pair sharing several cells is only reported from the cell holding the
+  // minimum corner of the two bounds' intersection.
+  for (int slot : usedCells)
+  {
+    const Cell &cell = cells[slot];
+    const int *members = cellBodies.data() + cell.start;
+
+    for (int i = 0; i < cell.count; i++)
+    {
+      const AABB &boxA = bounds[members[i]];
+      for (int j = i + 1; j < cell.count; j++)
+      {
+        const AABB &boxB = bounds[members[j]];
+        if (!aabbOverlap(boxA, boxB))
+          continue;
+
+        if (cellCoordinate(std::max(boxA.min.x, boxB.min.x)) != cell.x || cellCoordinate(std::max(boxA.min.y, boxB.min.y)) != cell.y)
+          continue;
+
+        pairs.push_back({std::min(members[i], members[j]), std::max(members[i], members[j])});
+      }
+    }
+  }
+}
+
+void SpatialHashGrid::query(const AABB &box, const std::vector<AABB> &bounds, std::vector<int> &bodies) const
+{
+  int minX = cellCoordinate(box.min.x);
+  int minY = cellCoordinate(box.min.y);
+  int maxX = cellCoordinate(box.max.x);
+  int maxY = cellCoordinate(box.max.y);
+
+  for (int y = minY; y <= maxY; y++)
+  {
+    for (int x = minX; x <= maxX; x++)
+    {
+      int slot = findCell(x, y);
+      if (slot < 0)
+        continue;
+
+      const Cell &cell = cells[slot];
+      for (int i = 0; i < cell.count; i++)
+      {
+        int body = cellBodies[cell.start + i];
+        if (body >= static_cast<int>(bounds.size()) || !aabbOverlap(bounds[body], box))
+          continue;
+
+        // Same rule as findPairs: only the cell at the minimum corner of the
+        // overlap reports the body.
+        if (cellCoordinate(std::max(box.min.x, bounds[body].min.x)) != x || cellCoordinate(std::max(box.min.y, bounds[body].min.y)) != y)
+          continue;
+
+        bodies.push_back(body);
+      }
+    }
+  }
+}
+
+void SpatialHashGrid::reserve(int bodyCount)
+{
+  int entryCount = 9 * bodyCount;
+  growTable(entryCount);
+  usedCells.reserve(entryCount);
+  entries.reserve(entryCount);
+  cellBodies.reserve(entryCount);
+}
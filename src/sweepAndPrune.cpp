@@ -0,0 +1,141 @@
+#include "Includes/sweepAndPrune.h"
+#include <algorithm>
+
+// Minimums sort ahead of maximums with the same value so touching intervals
+// still count as overlapping.
+static bool endpointLess(const SweepAndPrune::Endpoint &a, const SweepAndPrune::Endpoint &b)
+{
+  return a.value < b.value || (a.value == b.value && a.isMin && !b.isMin);
+}
+
+void SweepAndPrune::findPairs(const std::vector<AABB> &bounds, std::vector<BodyPair> &pairs)
+{
+  pairs.clear();
+
+  bool bodiesAdded = static_cast<int>(bounds.size()) != trackedBodies;
+  if (bodiesAdded)
+  {
+    addBodies(bounds);
+  }
+  bodiesAdded = bodiesAdded || unsorted;
+  unsorted = false;
+
+  for (Endpoint &endpoint : endpoints)
+  {
+    const AABB &box = bounds[endpoint.body];
+    endpoint.value = endpoint.isMin ? box.min.x : box.max.x;
+  }
+
+  // Freshly appended endpoints are in arbitrary order, which is the worst
+  // case for an insertion sort, so fall back to a full sort for that step.
+  if (bodiesAdded)
+  {
+    std::sort(endpoints.begin(), endpoints.end(), endpointLess);
+  }
+  else
+  {
+    sortEndpoints();
+  }
+
+  active.clear();
+  for (const Endpoint &endpoint : endpoints)
+  {
+    if (!endpoint.isMin)
+    {
+      auto it = std::find(active.begin(), active.end(), endpoint.body);
+      *it = active.back();
+      active.pop_back();
+      continue;
+    }
+
+    const AABB &box = bounds[endpoint.body];
+    for (int other : active)
+    {
+      const AABB &otherBox = bounds[other];
+      if (box.max.y >= otherBox.min.y && otherBox.max.y >= box.min.y)
+      {
+        pairs.push_back({std::min(endpoint.body, other), std::max(endpoint.body, other)});
+      }
+    }
+    active.push_back(endpoint.body);
+  }
+}
+
+void SweepAndPrune::query(const AABB &box, const std::vector<AABB> &bounds, std::vector<int> &bodies) const
+{
+  for (const Endpoint &endpoint : endpoints)
+  {
+    if (endpoint.value > box.max.x)
+      break;
+
+    if (endpoint.isMin && endpoint.body < static_cast<int>(bounds.size()) && aabbOverlap(bounds[endpoint.body], box))
+    {
+      bodies.push_back(endpoint.body);
+    }
+  }
+}
+
+// Surviving endpoints keep their order, so only bodies that moved into a
+// freed id need new endpoints, and those force one full sort.
+void SweepAndPrune::remapBodies(const std::vector<int> &newIndices, int bodyCount)
+{
+  trackedFlags.assign(bodyCount, 0);
+  int kept = 0;
+  for (const Endpoint &endpoint : endpoints)
+  {
+    int body = newIndices[endpoint.body];
+    if (body < 0)
+      continue;
+
+    endpoints[kept] = endpoint;
+    endpoints[kept].body = body;
+    trackedFlags[body] = 1;
+    kept++;
+  }
+  endpoints.resize(kept);
+
+  for (int i = 0; i < bodyCount; i++)
+  {
+    if (trackedFlags[i])
+      continue;
+
+    endpoints.push_back({0.0f, i, true});
+    endpoints.push_back({0.0f, i, false});
+    unsorted = true;
+  }
+  trackedBodies = bodyCount;
+}
+
+void SweepAndPrune::reserve(int bodyCount)
+{
+  endpoints.reserve(2 * bodyCount);
+  active.reserve(bodyCount);
+  trackedFlags.reserve(bodyCount);
+}
+
+void SweepAndPrune::addBodies(const std::vector<AABB> &bounds)
+{
+  int count = static_cast<int>(bounds.size());
+  for (int i = trackedBodies; i < count; i++)
+  {
+    endpoints.push_back({bounds[i].min.x, i, true});
+    endpoints.push_back({bounds[i].max.x, i, false});
+  }
+  trackedBodies = count;
+}
+
+void SweepAndPrune::sortEndpoints()
+{
+  int count = static_cast<int>(endpoints.size());
+  for (int i = 1; i < count; i++)
+  {
+    Endpoint key = endpoints[i];
+    int j = i - 1;
+    while (j >= 0 && endpointLess(key, endpoints[j]))
+    {
+      endpoints[j + 1] = endpoints[j];
+      j--;
+    }
+    endpoints[j + 1] = key;
+  }
+}
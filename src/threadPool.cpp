@@ -0,0 +1,184 @@
+#include "Includes/threadPool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(int workerCount)
+{
+  if (workerCount <= 0)
+  {
+    workerCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  }
+
+  for (int i = 0; i < workerCount; i++)
+  {
+    queues.push_back(std::make_unique<WorkerQueue>());
+  }
+
+  // Worker 0 is whichever thread calls parallelFor.
+  for (int i = 1; i < workerCount; i++)
+  {
+    threads.emplace_back(&ThreadPool::workerLoop, this, i);
+  }
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(wakeMutex);
+    stopping = true;
+  }
+  wakeCondition.notify_all();
+
+  for (std::thread &thread : threads)
+  {
+    thread.join();
+  }
+}
+
+int ThreadPool::workerCount() const
+{
+  return static_cast<int>(queues.size());
+}
+
+FrameArena &ThreadPool::arena(int worker)
+{
+  return queues[worker]->arena;
+}
+
+void ThreadPool::resetArenas()
+{
+  for (std::unique_ptr<WorkerQueue> &queue : queues)
+  {
+    queue->arena.reset();
+  }
+}
+
+void ThreadPool::reserveArenas(size_t capacity)
+{
+  for (std::unique_ptr<WorkerQueue> &queue : queues)
+  {
+    queue->arena.reserve(capacity);
+  }
+}
+
+void ThreadPool::parallelFor(int count, int grainSize, JobFunction function, void *context)
+{
+  if (count <= 0)
+    return;
+
+  grainSize = std::max(1, grainSize);
+  if (queues.size() == 1 || count <= grainSize)
+  {
+    function(context, 0, count, 0);
+    return;
+  }
+
+  int jobCount = (count + grainSize - 1) / grainSize;
+  int workers = workerCount();
+  pendingJobs.fetch_add(jobCount, std::memory_order_relaxed);
+
+  for (int i = 0; i < jobCount; i++)
+  {
+    Job job{function, context, i * grainSize, std::min(count, (i + 1) * grainSize)};
+    if (!push(i % workers, job))
+    {
+      // The queue is full; doing the job here is as good as waiting for room.
+      function(context, job.begin, job.end, 0);
+      pendingJobs.fetch_sub(1, std::memory_order_acq_rel);
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(wakeMutex);
+    generation++;
+  }
+  wakeCondition.notify_all();
+
+  while (pendingJobs.load(std::memory_order_acquire) > 0)
+  {
+    if (!runOne(0))
+    {
+      std::this_thread::yield();
+    }
+  }
+}
+
+
+bool ThreadPool::push(int worker, const Job &job)
+{
+  WorkerQueue &queue = *queues[worker];
+  std::lock_guard<std::mutex> lock(queue.mutex);
+  if (queue.tail - queue.head == queueCapacity)
+    return false;
+
+  queue.jobs[queue.tail % queueCapacity] = job;
+  queue.tail++;
+  return true;
+}
+
+bool ThreadPool::pop(int worker, Job &job)
+{
+  WorkerQueue &queue = *queues[worker];
+  std::lock_guard<std::mutex> lock(queue.mutex);
+  if (queue.tail == queue.head)
+    return false;
+
+  queue.tail--;
+  job = queue.jobs[queue.tail % queueCapacity];
+  if (queue.tail == queue.head)
+  {
+    queue.head = 0;
+    queue.tail = 0;
+  }
+  return true;
+}
+
+bool ThreadPool::steal(int thief, Job &job)
+{
+  int workers = workerCount();
+  for (int i = 1; i < workers; i++)
+  {
+    WorkerQueue &queue = *queues[(thief + i) % workers];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tail == queue.head)
+      continue;
+
+    job = queue.jobs[queue.head % queueCapacity];
+    queue.head++;
+    if (queue.tail == queue.head)
+    {
+      queue.head = 0;
+      queue.tail = 0;
+    }
+    return true;
+  }
+  return false;
+}
+
+bool ThreadPool::runOne(int worker)
+{
+  Job job;
+  if (!pop(worker, job) && !steal(worker, job))
+    return false;
+
+  job.function(job.context, job.begin, job.end, worker);
+  pendingJobs.fetch_sub(1, std::memory_order_acq_rel);
+  return true;
+}
+
+void ThreadPool::workerLoop(int worker)
+{
+  unsigned int seen = 0;
+  while (true)
+  {
+    while (runOne(worker))
+    {
+    }
+
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    wakeCondition.wait(lock, [&]
+                       { return stopping || generation != seen; });
+    if (stopping)
+      return;
+    seen = generation;
+  }
+}
@@ -0,0 +1,131 @@
+#include "Includes/trace.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct TraceEvent
+{
+  const char *name;
+  long long start;
+  long long end;
+};
+
+// Written only by its own thread. written counts every event ever recorded;
+// the slot of event i is i modulo capacity. begin is where the current
+// recording started.
+struct TraceBuffer
+{
+  static const unsigned long long capacity = 1 << 16;
+
+  int thread;
+  unsigned long long begin = 0;
+  std::atomic<unsigned long long> written{0};
+  TraceEvent events[capacity];
+};
+
+static std::atomic<bool> recording{false};
+static std::mutex registryMutex;
+static std::vector<std::unique_ptr<TraceBuffer>> buffers;
+
+// Buffers outlive their threads, so a buffer is never freed while an event
+// might still be written to it or read from it.
+static TraceBuffer *threadBuffer()
+{
+  thread_local TraceBuffer *buffer = nullptr;
+  if (!buffer)
+  {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    buffers.push_back(std::make_unique<TraceBuffer>());
+    buffer = buffers.back().get();
+    buffer->thread = static_cast<int>(buffers.size());
+  }
+  return buffer;
+}
+
+void traceStart()
+{
+  std::lock_guard<std::mutex> lock(registryMutex);
+  for (std::unique_ptr<TraceBuffer> &buffer : buffers)
+  {
+    buffer->begin = buffer->written.load(std::memory_order_acquire);
+  }
+  recording.store(true, std::memory_order_release);
+}
+
+void traceStop()
+{
+  recording.store(false, std::memory_order_release);
+}
+
+bool traceRecording()
+{
+  return recording.load(std::memory_order_relaxed);
+}
+
+long long traceNow()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void traceRecord(const char *name, long long start, long long end)
+{
+  TraceBuffer *buffer = threadBuffer();
+  unsigned long long index = buffer->written.load(std::memory_order_relaxed);
+  buffer->events[index % TraceBuffer::capacity] = TraceEvent{name, start, end};
+  buffer->written.store(index + 1, std::memory_order_release);
+}
+
+// Index of the oldest event of the current recording still in the buffer.
+static unsigned long long oldestEvent(const TraceBuffer &buffer, unsigned long long end)
+{
+  return end > TraceBuffer::capacity ? std::max(buffer.begin, end - TraceBuffer::capacity) : buffer.begin;
+}
+
+// Chrome trace timestamps are in microseconds. Times are taken relative to
+// the earliest event so they stay readable.
+bool traceWrite(const char *path)
+{
+  FILE *file = fopen(path, "w");
+  if (!file)
+    return false;
+
+  std::lock_guard<std::mutex> lock(registryMutex);
+
+  long long origin = -1;
+  for (std::unique_ptr<TraceBuffer> &buffer : buffers)
+  {
+    unsigned long long end = buffer->written.load(std::memory_order_acquire);
+    for (unsigned long long i = oldestEvent(*buffer, end); i < end; i++)
+    {
+      long long start = buffer->events[i % TraceBuffer::capacity].start;
+      if (origin < 0 || start < origin)
+        origin = start;
+    }
+  }
+
+  fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  bool firstEvent = true;
+  for (std::unique_ptr<TraceBuffer> &buffer : buffers)
+  {
+    fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}",
+            firstEvent ? "" : ",\n", buffer->thread, buffer->thread);
+    firstEvent = false;
+
+    unsigned long long end = buffer->written.load(std::memory_order_acquire);
+    for (unsigned long long i = oldestEvent(*buffer, end); i < end; i++)
+    {
+      const TraceEvent &event = buffer->events[i % TraceBuffer::capacity];
+      fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+              event.name, buffer->thread, (event.start - origin) / 1000.0, (event.end - event.start) / 1000.0);
+    }
+  }
+  fprintf(file, "\n]}\n");
+
+  bool written = !ferror(file);
+  fclose(file);
+  return written;
+}